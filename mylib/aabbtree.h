@@ -0,0 +1,591 @@
+#pragma once
+/*
+AABBTree - Dynamic bounding volume hierarchy
+Binary tree of boxes where every leaf is an object and every branch holds a
+box around both of its children. Leaves are given slightly bigger ("fat")
+boxes than they need, so objects only have to be moved around the tree once
+they leave them. The tree keeps itself balanced with rotations as objects are
+added and removed, so queries stay logarithmic
+Based on Box2D's b2DynamicTree
+*/
+
+#include "darray.h"
+#include "octcube.h"
+#include "vector3.h"
+
+template <class T>
+struct AABBNode
+{
+	// fat box for leaves, box around both children for branches
+	OctCube box;
+	T data;
+
+	// also used as the next free node when this node isn't being used
+	int parent;
+	int child1;
+	int child2;
+
+	// leaves are 0, free nodes are -1
+	int height;
+
+	bool isLeaf() const { return child1 == -1; }
+};
+
+template <class T>
+class AABBTree
+{
+public:
+	/***
+	 * @brief Makes an empty tree
+	 *
+	 * @param margin How much bigger than they need to be leaf boxes are made
+	 * @param predict How far along an object's displacement its leaf box is
+	 *			stretched, so fast objects don't need moving every time
+	 */
+	AABBTree(float margin = 0.1f, float predict = 2.0f)
+		: m_margin(margin), m_predict(predict)
+	{
+		m_root = -1;
+		m_freeList = -1;
+		m_count = 0;
+	}
+
+	/***
+	 * @brief Puts an object into the tree
+	 *
+	 * @param object Object to add
+	 * @param vol Bounding box of the object
+	 * @param displacement How far the object is expected to move
+	 * @return Handle used to move or remove the object later
+	 */
+	int add(T object, OctCube const& vol,
+		Vector3 const& displacement = Vector3())
+	{
+		int leaf = allocateNode();
+		m_nodes[leaf].box = fatten(vol, displacement);
+		m_nodes[leaf].data = object;
+		m_nodes[leaf].height = 0;
+
+		insertLeaf(leaf);
+		m_count++;
+		return leaf;
+	}
+
+	/***
+	 * @brief Takes an object out of the tree
+	 *
+	 * @param handle Handle given when the object was added
+	 */
+	void remove(int handle)
+	{
+		removeLeaf(handle);
+		freeNode(handle);
+		m_count--;
+	}
+
+	/***
+	 * @brief Moves an object in the tree, which is only actually done if its
+	 *			new box goes outside of its fat box
+	 *
+	 * @param handle Handle given when the object was added
+	 * @param vol New bounding box of the object
+	 * @param displacement How far the object is expected to move
+	 * @return Whether or not the object had to be re-inserted
+	 */
+	bool move(int handle, OctCube const& vol,
+		Vector3 const& displacement = Vector3())
+	{
+		if (contains(m_nodes[handle].box, vol))
+			return false;
+
+		removeLeaf(handle);
+		m_nodes[handle].box = fatten(vol, displacement);
+		insertLeaf(handle);
+		return true;
+	}
+
+	/***
+	 * @brief Gets every object whose fat box intersects a range
+	 *
+	 * @param range Box to check for intersection
+	 * @param list Array the objects are added onto
+	 */
+	void query(OctCube const& range, DArray<T>& list)
+	{
+		if (m_root == -1)
+			return;
+
+		m_stack.clear();
+		m_stack.add(m_root);
+		while (m_stack.getCount() > 0)
+		{
+			int index = m_stack[m_stack.getCount() - 1];
+			m_stack.pop();
+
+			AABBNode<T>& node = m_nodes[index];
+			if (!cubesIntersect(node.box, range))
+				continue;
+
+			if (node.isLeaf())
+			{
+				list.add(node.data);
+			}
+			else
+			{
+				m_stack.add(node.child1);
+				m_stack.add(node.child2);
+			}
+		}
+	}
+
+	/***
+	 * @brief Gets every object whose fat box is hit by a ray
+	 *
+	 * @param start Start point of the ray
+	 * @param dir Direction of the ray
+	 * @param maxDist How far along the ray to check
+	 * @param list Array the objects are added onto
+	 */
+	void rayCast(Vector3 const& start, Vector3 const& dir, float maxDist,
+		DArray<T>& list)
+	{
+		if (m_root == -1)
+			return;
+
+		m_stack.clear();
+		m_stack.add(m_root);
+		while (m_stack.getCount() > 0)
+		{
+			int index = m_stack[m_stack.getCount() - 1];
+			m_stack.pop();
+
+			AABBNode<T>& node = m_nodes[index];
+			if (!rayHitsBox(node.box, start, dir, maxDist))
+				continue;
+
+			if (node.isLeaf())
+			{
+				list.add(node.data);
+			}
+			else
+			{
+				m_stack.add(node.child1);
+				m_stack.add(node.child2);
+			}
+		}
+	}
+
+	/***
+	 * @brief Removes everything from the tree
+	 */
+	void clear()
+	{
+		m_nodes.clear();
+		m_root = -1;
+		m_freeList = -1;
+		m_count = 0;
+	}
+
+	int getCount() { return m_count; }
+	// height of the whole tree, 0 if it's empty or just one leaf
+	int getHeight() { return m_root == -1 ? 0 : m_nodes[m_root].height; }
+
+	T getObject(int handle) { return m_nodes[handle].data; }
+	OctCube getFatBox(int handle) { return m_nodes[handle].box; }
+
+private:
+	DArray<AABBNode<T>> m_nodes;
+	int m_root;
+	int m_freeList;
+	int m_count;
+
+	float m_margin;
+	float m_predict;
+
+	// kept around so queries don't need to allocate their own
+	DArray<int> m_stack;
+
+	int allocateNode()
+	{
+		int index;
+		if (m_freeList != -1)
+		{
+			index = m_freeList;
+			m_freeList = m_nodes[index].parent;
+		}
+		else
+		{
+			index = m_nodes.getCount();
+			m_nodes.add(AABBNode<T>());
+		}
+
+		AABBNode<T>& node = m_nodes[index];
+		node.parent = -1;
+		node.child1 = -1;
+		node.child2 = -1;
+		node.height = 0;
+		return index;
+	}
+
+	void freeNode(int index)
+	{
+		m_nodes[index].parent = m_freeList;
+		m_nodes[index].height = -1;
+		m_freeList = index;
+	}
+
+	// grows a box by the margin and stretches it along its displacement
+	OctCube fatten(OctCube const& vol, Vector3 const& displacement)
+	{
+		OctCube fat = vol;
+		fat.minX -= m_margin;
+		fat.minY -= m_margin;
+		fat.minZ -= m_margin;
+		fat.maxX += m_margin;
+		fat.maxY += m_margin;
+		fat.maxZ += m_margin;
+
+		float dx = displacement.x * m_predict;
+		float dy = displacement.y * m_predict;
+		float dz = displacement.z * m_predict;
+
+		if (dx < 0.0f) fat.minX += dx; else fat.maxX += dx;
+		if (dy < 0.0f) fat.minY += dy; else fat.maxY += dy;
+		if (dz < 0.0f) fat.minZ += dz; else fat.maxZ += dz;
+
+		return fat;
+	}
+
+	static OctCube combine(OctCube const& a, OctCube const& b)
+	{
+		OctCube result;
+		result.minX = a.minX < b.minX ? a.minX : b.minX;
+		result.minY = a.minY < b.minY ? a.minY : b.minY;
+		result.minZ = a.minZ < b.minZ ? a.minZ : b.minZ;
+		result.maxX = a.maxX > b.maxX ? a.maxX : b.maxX;
+		result.maxY = a.maxY > b.maxY ? a.maxY : b.maxY;
+		result.maxZ = a.maxZ > b.maxZ ? a.maxZ : b.maxZ;
+		return result;
+	}
+
+	// surface area (well, half of it), used as the cost of a box
+	static float area(OctCube const& a)
+	{
+		float w = a.maxX - a.minX;
+		float h = a.maxY - a.minY;
+		float d = a.maxZ - a.minZ;
+		return w * h + h * d + d * w;
+	}
+
+	// checks if the box a completely contains the box b
+	static bool contains(OctCube const& a, OctCube const& b)
+	{
+		return a.minX <= b.minX && a.minY <= b.minY && a.minZ <= b.minZ &&
+			a.maxX >= b.maxX && a.maxY >= b.maxY && a.maxZ >= b.maxZ;
+	}
+
+	// slab test of a ray against a box
+	static bool rayHitsBox(OctCube const& box, Vector3 const& start,
+		Vector3 const& dir, float maxDist)
+	{
+		float tMin = 0.0f;
+		float tMax = maxDist;
+
+		float starts[3] = { start.x, start.y, start.z };
+		float dirs[3] = { dir.x, dir.y, dir.z };
+		float mins[3] = { box.minX, box.minY, box.minZ };
+		float maxs[3] = { box.maxX, box.maxY, box.maxZ };
+
+		for (int i = 0; i < 3; ++i)
+		{
+			if (dirs[i] == 0.0f)
+			{
+				// parallel to this slab, so it has to start inside it
+				if (starts[i] < mins[i] || starts[i] > maxs[i])
+					return false;
+				continue;
+			}
+
+			float t1 = (mins[i] - starts[i]) / dirs[i];
+			float t2 = (maxs[i] - starts[i]) / dirs[i];
+			if (t1 > t2)
+			{
+				float temp = t1;
+				t1 = t2;
+				t2 = temp;
+			}
+
+			if (t1 > tMin)
+				tMin = t1;
+			if (t2 < tMax)
+				tMax = t2;
+			if (tMin > tMax)
+				return false;
+		}
+
+		return true;
+	}
+
+	/***
+	 * @brief Finds the best place for a leaf by how much it'd grow the tree
+	 *			and puts it there
+	 */
+	void insertLeaf(int leaf)
+	{
+		if (m_root == -1)
+		{
+			m_root = leaf;
+			m_nodes[leaf].parent = -1;
+			return;
+		}
+
+		// find the best sibling for this leaf
+		OctCube leafBox = m_nodes[leaf].box;
+		int index = m_root;
+		while (!m_nodes[index].isLeaf())
+		{
+			AABBNode<T>& node = m_nodes[index];
+			int child1 = node.child1;
+			int child2 = node.child2;
+
+			float nodeArea = area(node.box);
+			float combinedArea = area(combine(node.box, leafBox));
+
+			// cost of making a new parent for this node and the leaf
+			float cost = 2.0f * combinedArea;
+			// minimum cost of pushing the leaf further down the tree
+			float inheritanceCost = 2.0f * (combinedArea - nodeArea);
+
+			float cost1 = childCost(child1, leafBox) + inheritanceCost;
+			float cost2 = childCost(child2, leafBox) + inheritanceCost;
+
+			// stop here if going further down would cost more
+			if (cost < cost1 && cost < cost2)
+				break;
+
+			index = cost1 < cost2 ? child1 : child2;
+		}
+
+		int sibling = index;
+
+		// make a new parent for the sibling and the leaf
+		int oldParent = m_nodes[sibling].parent;
+		int newParent = allocateNode();
+		m_nodes[newParent].parent = oldParent;
+		m_nodes[newParent].box = combine(leafBox, m_nodes[sibling].box);
+		m_nodes[newParent].height = m_nodes[sibling].height + 1;
+		m_nodes[newParent].child1 = sibling;
+		m_nodes[newParent].child2 = leaf;
+		m_nodes[sibling].parent = newParent;
+		m_nodes[leaf].parent = newParent;
+
+		if (oldParent != -1)
+		{
+			// the sibling wasn't the root
+			if (m_nodes[oldParent].child1 == sibling)
+				m_nodes[oldParent].child1 = newParent;
+			else
+				m_nodes[oldParent].child2 = newParent;
+		}
+		else
+		{
+			// the sibling was the root
+			m_root = newParent;
+		}
+
+		// walk back up fixing heights and boxes
+		refit(m_nodes[leaf].parent);
+	}
+
+	// cost of putting a leaf with a box under a child
+	float childCost(int child, OctCube const& leafBox)
+	{
+		OctCube box = combine(leafBox, m_nodes[child].box);
+		if (m_nodes[child].isLeaf())
+			return area(box);
+		return area(box) - area(m_nodes[child].box);
+	}
+
+	/***
+	 * @brief Takes a leaf out of the tree, its sibling takes its parent's
+	 *			place
+	 */
+	void removeLeaf(int leaf)
+	{
+		if (leaf == m_root)
+		{
+			m_root = -1;
+			return;
+		}
+
+		int parent = m_nodes[leaf].parent;
+		int grandParent = m_nodes[parent].parent;
+		int sibling = m_nodes[parent].child1 == leaf ?
+			m_nodes[parent].child2 : m_nodes[parent].child1;
+
+		if (grandParent != -1)
+		{
+			// connect the sibling to the grandparent and get rid of the parent
+			if (m_nodes[grandParent].child1 == parent)
+				m_nodes[grandParent].child1 = sibling;
+			else
+				m_nodes[grandParent].child2 = sibling;
+			m_nodes[sibling].parent = grandParent;
+			freeNode(parent);
+
+			refit(grandParent);
+		}
+		else
+		{
+			m_root = sibling;
+			m_nodes[sibling].parent = -1;
+			freeNode(parent);
+		}
+	}
+
+	// rebalances and recalculates boxes from a node up to the root
+	void refit(int index)
+	{
+		while (index != -1)
+		{
+			index = balance(index);
+
+			AABBNode<T>& node = m_nodes[index];
+			AABBNode<T>& child1 = m_nodes[node.child1];
+			AABBNode<T>& child2 = m_nodes[node.child2];
+
+			node.height = 1 + (child1.height > child2.height ?
+				child1.height : child2.height);
+			node.box = combine(child1.box, child2.box);
+
+			index = node.parent;
+		}
+	}
+
+	/***
+	 * @brief Rotates a node's taller child up if one side of it is too much
+	 *			taller than the other
+	 *
+	 * @param iA Index of the node to balance
+	 * @return Index of the node that ends up where iA was
+	 */
+	int balance(int iA)
+	{
+		AABBNode<T>& A = m_nodes[iA];
+		if (A.isLeaf() || A.height < 2)
+			return iA;
+
+		int iB = A.child1;
+		int iC = A.child2;
+		AABBNode<T>& B = m_nodes[iB];
+		AABBNode<T>& C = m_nodes[iC];
+
+		int balance = C.height - B.height;
+
+		// rotate C up
+		if (balance > 1)
+		{
+			int iF = C.child1;
+			int iG = C.child2;
+			AABBNode<T>& F = m_nodes[iF];
+			AABBNode<T>& G = m_nodes[iG];
+
+			// swap A and C
+			C.child1 = iA;
+			C.parent = A.parent;
+			A.parent = iC;
+
+			// A's old parent should point to C
+			replaceChild(C.parent, iA, iC);
+
+			// keep the taller of C's children up with C
+			if (F.height > G.height)
+			{
+				C.child2 = iF;
+				A.child2 = iG;
+				G.parent = iA;
+				A.box = combine(B.box, G.box);
+				C.box = combine(A.box, F.box);
+
+				A.height = 1 + maxOf(B.height, G.height);
+				C.height = 1 + maxOf(A.height, F.height);
+			}
+			else
+			{
+				C.child2 = iG;
+				A.child2 = iF;
+				F.parent = iA;
+				A.box = combine(B.box, F.box);
+				C.box = combine(A.box, G.box);
+
+				A.height = 1 + maxOf(B.height, F.height);
+				C.height = 1 + maxOf(A.height, G.height);
+			}
+
+			return iC;
+		}
+
+		// rotate B up
+		if (balance < -1)
+		{
+			int iD = B.child1;
+			int iE = B.child2;
+			AABBNode<T>& D = m_nodes[iD];
+			AABBNode<T>& E = m_nodes[iE];
+
+			// swap A and B
+			B.child1 = iA;
+			B.parent = A.parent;
+			A.parent = iB;
+
+			// A's old parent should point to B
+			replaceChild(B.parent, iA, iB);
+
+			// keep the taller of B's children up with B
+			if (D.height > E.height)
+			{
+				B.child2 = iD;
+				A.child1 = iE;
+				E.parent = iA;
+				A.box = combine(C.box, E.box);
+				B.box = combine(A.box, D.box);
+
+				A.height = 1 + maxOf(C.height, E.height);
+				B.height = 1 + maxOf(A.height, D.height);
+			}
+			else
+			{
+				B.child2 = iE;
+				A.child1 = iD;
+				D.parent = iA;
+				A.box = combine(C.box, D.box);
+				B.box = combine(A.box, E.box);
+
+				A.height = 1 + maxOf(C.height, D.height);
+				B.height = 1 + maxOf(A.height, E.height);
+			}
+
+			return iB;
+		}
+
+		return iA;
+	}
+
+	// points a parent at a new child, or makes it the root if there's no
+	// parent
+	void replaceChild(int parent, int oldChild, int newChild)
+	{
+		if (parent == -1)
+		{
+			m_root = newChild;
+			return;
+		}
+
+		if (m_nodes[parent].child1 == oldChild)
+			m_nodes[parent].child1 = newChild;
+		else
+			m_nodes[parent].child2 = newChild;
+	}
+
+	static int maxOf(int a, int b) { return a > b ? a : b; }
+};
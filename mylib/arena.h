@@ -0,0 +1,167 @@
+#pragma once
+/*
+Arena - Linear scratch allocator
+Hands out memory by bumping an offset along big blocks, and everything is
+given back at once by going back to an earlier mark, so short-lived arrays
+don't have to go through new/delete every time
+Blocks are kept once they've been made, so once an arena has grown to fit
+whatever's done with it, it never allocates again
+
+Only use it for things that don't need their destructors run, nothing
+handed out is ever destroyed
+
+Usually used through a scope:
+	ArenaScope scope(Arena::getThreadArena());
+	Vector3* points = scope.alloc<Vector3>(count);
+and everything's handed back when the scope ends
+*/
+
+#include <cstddef>
+#include <new>
+#include <type_traits>
+
+#include "darray.h"
+
+class Arena
+{
+public:
+	// where an arena is up to, to go back to later
+	struct Mark
+	{
+		int block;
+		size_t used;
+	};
+
+	Arena(size_t blockSize = 64 * 1024)
+		: m_blockSize(blockSize), m_current(0), m_used(0) {}
+
+	~Arena()
+	{
+		for (int i = 0; i < m_blocks.getCount(); ++i)
+			delete[] m_blocks[i].memory;
+	}
+
+	// not copyable, the blocks would be deleted twice
+	Arena(Arena const&) = delete;
+	Arena& operator=(Arena const&) = delete;
+
+	/***
+	 * @brief Grabs space for a number of objects, default constructed
+	 *
+	 * @param count How many objects to make room for
+	 * @return Pointer to the first object, valid until the arena goes back
+	 *			to a mark from before this
+	 */
+	template <typename T>
+	T* alloc(int count)
+	{
+		static_assert(std::is_trivially_destructible<T>::value,
+			"arena objects are never destroyed");
+
+		T* items = (T*)allocBytes(sizeof(T) * count, alignof(T));
+		for (int i = 0; i < count; ++i)
+			new (&items[i]) T();
+		return items;
+	}
+
+	// gets where the arena is up to right now
+	Mark getMark()
+	{
+		Mark mark;
+		mark.block = m_current;
+		mark.used = m_used;
+		return mark;
+	}
+
+	// hands back everything allocated since a mark was got
+	void reset(Mark const& mark)
+	{
+		m_current = mark.block;
+		m_used = mark.used;
+	}
+
+	// how much memory the arena's holding onto, used or not
+	size_t getCapacity()
+	{
+		size_t total = 0;
+		for (int i = 0; i < m_blocks.getCount(); ++i)
+			total += m_blocks[i].size;
+		return total;
+	}
+
+	/***
+	 * @brief Gets an arena that only the calling thread uses, so threads
+	 *			never have to share
+	 *
+	 * @return The calling thread's arena, made the first time it's asked for
+	 */
+	static Arena* getThreadArena()
+	{
+		static thread_local Arena arena;
+		return &arena;
+	}
+
+private:
+	struct Block
+	{
+		char* memory;
+		size_t size;
+	};
+
+	DArray<Block> m_blocks;
+	size_t m_blockSize;
+	// block being allocated from, and how much of it's been used
+	int m_current;
+	size_t m_used;
+
+	void* allocBytes(size_t size, size_t align)
+	{
+		// move along to the next block (making it if it's not there yet)
+		// until one has enough room
+		while (true)
+		{
+			if (m_current < m_blocks.getCount())
+			{
+				Block& block = m_blocks[m_current];
+				// new[] lines blocks up for anything, so only the offset
+				// needs lining up
+				size_t start = (m_used + align - 1) & ~(align - 1);
+				if (start + size <= block.size)
+				{
+					m_used = start + size;
+					return block.memory + start;
+				}
+
+				// doesn't fit, skip the rest of this block
+				m_current++;
+				m_used = 0;
+				continue;
+			}
+
+			// out of blocks, make one big enough for this at least
+			Block block;
+			block.size = size + align > m_blockSize ? size + align : m_blockSize;
+			block.memory = new char[block.size];
+			m_blocks.add(block);
+		}
+	}
+};
+
+// goes back to where an arena was when the scope started once it ends
+class ArenaScope
+{
+public:
+	ArenaScope(Arena* arena)
+		: m_arena(arena), m_mark(arena->getMark()) {}
+	~ArenaScope() { m_arena->reset(m_mark); }
+
+	ArenaScope(ArenaScope const&) = delete;
+	ArenaScope& operator=(ArenaScope const&) = delete;
+
+	template <typename T>
+	T* alloc(int count) { return m_arena->alloc<T>(count); }
+
+private:
+	Arena* m_arena;
+	Arena::Mark m_mark;
+};
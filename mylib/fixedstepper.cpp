@@ -0,0 +1,32 @@
+#include "fixedstepper.h"
+
+FixedStepper::FixedStepper(float step, int maxSteps)
+	: m_step(step), m_maxSteps(maxSteps), m_accumulated(0.0f),
+	m_dropped(0.0f) { }
+
+int FixedStepper::advance(float frameTime)
+{
+	m_accumulated += frameTime;
+
+	int steps = (int)(m_accumulated / m_step);
+	if (steps > m_maxSteps)
+	{
+		// can't keep up, so give up on the steps that won't fit
+		float dropped = (steps - m_maxSteps) * m_step;
+		m_accumulated -= dropped;
+		m_dropped += dropped;
+		steps = m_maxSteps;
+	}
+
+	m_accumulated -= steps * m_step;
+	// rounding can leave it a tiny bit under 0
+	if (m_accumulated < 0.0f)
+		m_accumulated = 0.0f;
+	return steps;
+}
+
+float FixedStepper::getAlpha()
+{
+	float alpha = m_accumulated / m_step;
+	return alpha < 1.0f ? alpha : 1.0f;
+}
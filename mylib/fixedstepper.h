@@ -0,0 +1,83 @@
+#pragma once
+/*
+FixedStepper - Splits up frame time into fixed length steps
+Frames take however long they take, but things like physics want to be
+stepped by the same amount every time. Each frame's time is added on and the
+stepper says how many whole steps fit in what's built up, so the simulation
+keeps up with real time even when frames take longer than a step
+
+If frames take so long that the steps themselves can't keep up, running
+more steps each frame only makes the next frame slower still, so there's a
+limit on how many steps can be run at once and anything over that is thrown
+away (the simulation slows down instead of grinding to a halt)
+
+What's left over after the steps is less than one step, getAlpha() says
+how far through the next step that is, for drawing things part way between
+where they were at the last two steps
+
+	FixedStepper stepper(1.0f / 60.0f, 5);
+	int steps = stepper.advance(deltaTime);
+	for (int i = 0; i < steps; ++i)
+		step(stepper.getStep());
+	draw(stepper.getAlpha());
+*/
+
+#ifdef MYLIB_DYNAMIC
+	#ifdef MYLIB_EXPORT
+		#define MYLIB_SPEC __declspec(dllexport)
+	#else
+		#define MYLIB_SPEC __declspec(dllimport)
+	#endif
+#else
+	#define MYLIB_SPEC
+#endif
+
+class FixedStepper
+{
+public:
+	/***
+	 * @brief Makes a stepper with nothing built up
+	 *
+	 * @param step Length of each step
+	 * @param maxSteps Most steps that will be run in one frame
+	 */
+	MYLIB_SPEC FixedStepper(float step, int maxSteps);
+
+	/***
+	 * @brief Adds on how long the last frame took and works out how many
+	 *			steps need running to catch up
+	 *			If that's more than the limit, the time for the extra steps
+	 *			is thrown away
+	 *
+	 * @param frameTime How long the last frame took
+	 * @return Number of steps to run this frame
+	 */
+	MYLIB_SPEC int advance(float frameTime);
+
+	/***
+	 * @brief Gets how far through the next step the time that's built up
+	 *			is, for drawing between the last two steps
+	 *
+	 * @return 0 for right at the last step, up to 1 for right at the next
+	 */
+	MYLIB_SPEC float getAlpha();
+
+	float getStep() { return m_step; }
+	void setStep(float step) { m_step = step; }
+	int getMaxSteps() { return m_maxSteps; }
+	void setMaxSteps(int maxSteps) { m_maxSteps = maxSteps; }
+
+	// total time that's been thrown away because steps couldn't keep up
+	float getDroppedTime() { return m_dropped; }
+
+	// throws away whatever time has built up, for after a pause or loading
+	void reset() { m_accumulated = 0.0f; }
+
+private:
+	float m_step;
+	int m_maxSteps;
+
+	// time built up that hasn't been stepped yet
+	float m_accumulated;
+	float m_dropped;
+};
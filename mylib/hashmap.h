@@ -0,0 +1,198 @@
+#pragma once
+/*
+HashMap - Hash map with integer keys
+Everything is kept in one flat array, and keys that land on a taken slot
+just move along to the next free one (linear probing), so looking something
+up is usually a single read instead of walking a list like HashTable does
+*/
+
+#include "darray.h"
+
+template <typename V>
+class HashMap
+{
+public:
+	HashMap(int capacity = 16)
+		: m_count(0)
+	{
+		// capacity has to be a power of 2 so the hash can be masked
+		m_capacity = 16;
+		while (m_capacity < capacity)
+			m_capacity *= 2;
+		m_slots = new Slot[m_capacity];
+	}
+
+	~HashMap() { delete[] m_slots; }
+
+	// not copyable, both copies would delete the same slots
+	HashMap(HashMap const&) = delete;
+	HashMap& operator=(HashMap const&) = delete;
+
+	/***
+	 * @brief Finds the value stored with a key
+	 *
+	 * @param key Key to look for
+	 * @return Pointer to the value, or nullptr if the key isn't in the map
+	 *			Only valid until something else is added
+	 */
+	V* find(unsigned long long key)
+	{
+		int slot = findSlot(key);
+		return slot >= 0 ? &m_slots[slot].value : nullptr;
+	}
+
+	/***
+	 * @brief Gets a value by key. If the key doesn't exist, make a new entry
+	 *
+	 * @param key Key associated with a value
+	 * @return Value associated with the key, only valid until something else
+	 *			is added
+	 */
+	V& operator[](unsigned long long key)
+	{
+		int slot = findSlot(key);
+		if (slot >= 0)
+			return m_slots[slot].value;
+
+		// keep it at most 3/4 full so runs of taken slots stay short
+		if ((m_count + 1) * 4 > m_capacity * 3)
+			grow();
+
+		slot = hash(key) & (m_capacity - 1);
+		while (m_slots[slot].used)
+			slot = (slot + 1) & (m_capacity - 1);
+
+		m_slots[slot].key = key;
+		m_slots[slot].value = V();
+		m_slots[slot].used = true;
+		m_count++;
+		return m_slots[slot].value;
+	}
+
+	/***
+	 * @brief Takes a key and its value out of the map
+	 *
+	 * @param key Key to remove
+	 * @return Whether or not the key was in the map
+	 */
+	bool remove(unsigned long long key)
+	{
+		int hole = findSlot(key);
+		if (hole < 0)
+			return false;
+
+		m_slots[hole].used = false;
+		m_count--;
+
+		// anything after the hole that had to move along to get where it is
+		// gets shifted back into it, otherwise lookups would stop at the
+		// hole before reaching them
+		int mask = m_capacity - 1;
+		int slot = (hole + 1) & mask;
+		while (m_slots[slot].used)
+		{
+			int home = hash(m_slots[slot].key) & mask;
+			// distance from where it wants to be vs distance from the hole
+			if (((slot - home) & mask) >= ((slot - hole) & mask))
+			{
+				m_slots[hole] = m_slots[slot];
+				m_slots[slot].used = false;
+				hole = slot;
+			}
+			slot = (slot + 1) & mask;
+		}
+		return true;
+	}
+
+	/***
+	 * @brief Gets every key in the map, in no particular order
+	 *
+	 * @param out List to add the keys to
+	 */
+	void getKeys(DArray<unsigned long long>& out)
+	{
+		for (int i = 0; i < m_capacity; ++i)
+			if (m_slots[i].used)
+				out.add(m_slots[i].key);
+	}
+
+	/***
+	 * @brief Calls a function on every key and value in the map, in no
+	 *			particular order
+	 *			Nothing should be added or removed until it's done
+	 *
+	 * @param func Function taking each key and a reference to its value
+	 */
+	template <class F>
+	void forEach(F func)
+	{
+		for (int i = 0; i < m_capacity; ++i)
+			if (m_slots[i].used)
+				func(m_slots[i].key, m_slots[i].value);
+	}
+
+	// removes everything but keeps the memory around
+	void clear()
+	{
+		for (int i = 0; i < m_capacity; ++i)
+			m_slots[i].used = false;
+		m_count = 0;
+	}
+
+	int getCount() { return m_count; }
+
+private:
+	struct Slot
+	{
+		unsigned long long key;
+		V value;
+		bool used;
+
+		Slot() : key(0), used(false) {}
+	};
+
+	Slot* m_slots;
+	int m_capacity;
+	int m_count;
+
+	// mixes up all the bits of the key, keys that are close together
+	// (like ids packed together) would bunch up otherwise
+	static unsigned int hash(unsigned long long key)
+	{
+		key ^= key >> 33;
+		key *= 0xff51afd7ed558ccdULL;
+		key ^= key >> 33;
+		key *= 0xc4ceb9fe1a85ec53ULL;
+		key ^= key >> 33;
+		return (unsigned int)key;
+	}
+
+	int findSlot(unsigned long long key)
+	{
+		int slot = hash(key) & (m_capacity - 1);
+		while (m_slots[slot].used)
+		{
+			if (m_slots[slot].key == key)
+				return slot;
+			slot = (slot + 1) & (m_capacity - 1);
+		}
+		return -1;
+	}
+
+	// doubles the number of slots and puts everything back in
+	void grow()
+	{
+		Slot* old = m_slots;
+		int oldCapacity = m_capacity;
+
+		m_capacity *= 2;
+		m_slots = new Slot[m_capacity];
+		m_count = 0;
+
+		for (int i = 0; i < oldCapacity; ++i)
+			if (old[i].used)
+				(*this)[old[i].key] = old[i].value;
+
+		delete[] old;
+	}
+};
@@ -0,0 +1,243 @@
+#include "jobsystem.h"
+
+// which JobSystem the current thread works for and which queue is its own
+static thread_local JobSystem* t_system = nullptr;
+static thread_local int t_index = -1;
+
+JobSystem::JobSystem(int workers)
+{
+	if (workers < 0)
+	{
+		// leave a core for the thread that made us
+		int cores = (int)std::thread::hardware_concurrency();
+		workers = cores > 1 ? cores - 1 : 0;
+	}
+
+	m_queueCount = workers + 1;
+	m_queues = new WorkerQueue[m_queueCount];
+
+	m_queued = 0;
+	m_running = true;
+
+	// this thread gets the first queue
+	t_system = this;
+	t_index = 0;
+
+	m_threadCount = workers;
+	m_threads = new std::thread[m_threadCount];
+	for (int i = 0; i < m_threadCount; ++i)
+		m_threads[i] = std::thread(&JobSystem::workerLoop, this, i + 1);
+}
+
+JobSystem::~JobSystem()
+{
+	{
+		std::lock_guard<std::mutex> guard(m_sleepLock);
+		m_running = false;
+	}
+	m_wake.notify_all();
+
+	for (int i = 0; i < m_threadCount; ++i)
+		m_threads[i].join();
+
+	delete[] m_threads;
+	delete[] m_queues;
+
+	if (t_system == this)
+	{
+		t_system = nullptr;
+		t_index = -1;
+	}
+}
+
+Job* JobSystem::createJob(std::function<void()> func)
+{
+	auto job = new Job();
+	job->func = func;
+	// the extra one is taken off when it's submitted
+	job->waitingOn = 1;
+	job->closed = false;
+	job->finished = false;
+	return job;
+}
+
+void JobSystem::addDependency(Job* job, Job* dependency)
+{
+	std::lock_guard<std::mutex> guard(dependency->lock);
+
+	// nothing to wait for if it's already done
+	if (dependency->closed)
+		return;
+
+	job->waitingOn++;
+	dependency->dependents.add(job);
+}
+
+void JobSystem::submit(Job* job)
+{
+	// only actually queue it if nothing else is holding it up
+	if (--job->waitingOn == 0)
+		push(job);
+}
+
+void JobSystem::wait(Job* job)
+{
+	// threads that aren't ours share the first queue, which is where their
+	// jobs were pushed, so they can still run them when there's no workers
+	int index = getThreadIndex();
+	if (index < 0)
+		index = 0;
+
+	while (!job->finished)
+	{
+		// help out instead of just waiting around
+		Job* other = findJob(index);
+		if (other)
+			run(other);
+		else
+			std::this_thread::yield();
+	}
+}
+
+void JobSystem::parallelFor(int count, int batchSize,
+	std::function<void(int, int)> func)
+{
+	if (count <= 0)
+		return;
+	if (batchSize < 1)
+		batchSize = 1;
+
+	// a few batches per thread so threads that finish early can steal more
+	int batches = m_queueCount * 4;
+	int size = (count + batches - 1) / batches;
+	if (size < batchSize)
+		size = batchSize;
+
+	// not worth the overhead if it all fits in one batch or there's no one
+	// else to run the rest
+	if (size >= count || m_queueCount == 1)
+	{
+		func(0, count);
+		return;
+	}
+
+	DArray<Job*> jobs;
+	for (int start = 0; start < count; start += size)
+	{
+		int end = start + size < count ? start + size : count;
+		Job* job = createJob([func, start, end]() { func(start, end); });
+		jobs.add(job);
+		submit(job);
+	}
+
+	for (int i = 0; i < jobs.getCount(); ++i)
+	{
+		wait(jobs[i]);
+		delete jobs[i];
+	}
+}
+
+int JobSystem::getThreadIndex()
+{
+	return t_system == this ? t_index : -1;
+}
+
+void JobSystem::workerLoop(int index)
+{
+	t_system = this;
+	t_index = index;
+
+	while (m_running)
+	{
+		Job* job = findJob(index);
+		if (job)
+		{
+			run(job);
+			continue;
+		}
+
+		// nothing to do, sleep until something's pushed
+		std::unique_lock<std::mutex> lock(m_sleepLock);
+		m_wake.wait(lock, [this]() { return m_queued > 0 || !m_running; });
+	}
+}
+
+void JobSystem::push(Job* job)
+{
+	// threads that aren't ours just use the first queue
+	int index = getThreadIndex();
+	if (index < 0)
+		index = 0;
+
+	{
+		std::lock_guard<std::mutex> guard(m_queues[index].lock);
+		m_queues[index].jobs.push_back(job);
+	}
+
+	{
+		// lock so a worker can't miss this between checking and sleeping
+		std::lock_guard<std::mutex> guard(m_sleepLock);
+		m_queued++;
+	}
+	m_wake.notify_one();
+}
+
+Job* JobSystem::findJob(int index)
+{
+	if (m_queued == 0)
+		return nullptr;
+
+	// newest job from our own queue first, it's most likely still in cache
+	{
+		WorkerQueue& own = m_queues[index];
+		std::lock_guard<std::mutex> guard(own.lock);
+		if (!own.jobs.empty())
+		{
+			Job* job = own.jobs.back();
+			own.jobs.pop_back();
+			m_queued--;
+			return job;
+		}
+	}
+
+	// then steal the oldest job from everyone else
+	for (int i = 1; i < m_queueCount; ++i)
+	{
+		WorkerQueue& other = m_queues[(index + i) % m_queueCount];
+		std::lock_guard<std::mutex> guard(other.lock);
+		if (!other.jobs.empty())
+		{
+			Job* job = other.jobs.front();
+			other.jobs.pop_front();
+			m_queued--;
+			return job;
+		}
+	}
+
+	return nullptr;
+}
+
+void JobSystem::run(Job* job)
+{
+	if (job->func)
+		job->func();
+	finish(job);
+}
+
+void JobSystem::finish(Job* job)
+{
+	// take the dependents out so nothing else can be added to them
+	DArray<Job*> dependents;
+	{
+		std::lock_guard<std::mutex> guard(job->lock);
+		job->closed = true;
+		for (int i = 0; i < job->dependents.getCount(); ++i)
+			dependents.add(job->dependents[i]);
+	}
+
+	for (int i = 0; i < dependents.getCount(); ++i)
+		submit(dependents[i]);
+
+	// this has to be last, the job can be deleted as soon as it's set
+	job->finished = true;
+}
@@ -0,0 +1,160 @@
+#pragma once
+/*
+JobSystem - Work stealing job scheduler
+Every thread (including the one that made the JobSystem) has its own queue
+of jobs. Threads take jobs off the back of their own queue and when that's
+empty they steal from the front of everyone else's, so work spreads itself
+out without one big shared queue everyone fights over
+
+The first queue belongs to the thread that made the JobSystem. Any other
+thread can still submit and wait, it just shares that first queue with the
+owner, so jobs from two outside threads (or one outside thread and the
+owner) can end up being run by whichever of them is waiting
+*/
+
+#ifdef MYLIB_DYNAMIC
+	#ifdef MYLIB_EXPORT
+		#define MYLIB_SPEC __declspec(dllexport)
+	#else
+		#define MYLIB_SPEC __declspec(dllimport)
+	#endif
+#else
+	#define MYLIB_SPEC
+#endif
+
+#include <atomic>
+#include <condition_variable>
+#include <deque>
+#include <functional>
+#include <mutex>
+#include <thread>
+
+#include "darray.h"
+
+// a piece of work for the JobSystem
+// made with JobSystem::createJob and owned by whoever made it, but it can't
+// be deleted until it's been waited on
+struct Job
+{
+	std::function<void()> func;
+
+	// jobs that have to finish before this can run, plus one until it's
+	// been submitted
+	std::atomic<int> waitingOn;
+	// jobs waiting for this one to finish
+	DArray<Job*> dependents;
+
+	// set once dependents can't be added anymore
+	bool closed;
+	// set once the job has completely finished
+	std::atomic<bool> finished;
+
+	// guards dependents and closed
+	std::mutex lock;
+};
+
+class JobSystem
+{
+public:
+	/***
+	 * @brief Starts up the worker threads, the calling thread becomes the
+	 *			owner of the first queue
+	 *
+	 * @param workers Number of threads to make on top of the one making the
+	 *			JobSystem, -1 uses one less than the number of cores
+	 */
+	MYLIB_SPEC JobSystem(int workers = -1);
+	/***
+	 * @brief Stops and joins all the worker threads, every job should have
+	 *			been waited on first
+	 */
+	MYLIB_SPEC ~JobSystem();
+
+	/***
+	 * @brief Makes a job which doesn't run until it's submitted
+	 *
+	 * @param func Function the job runs
+	 * @return The new job, delete it once it's been waited on
+	 */
+	MYLIB_SPEC Job* createJob(std::function<void()> func);
+
+	/***
+	 * @brief Makes a job wait for another job to finish before it runs
+	 *			Has to be called before the waiting job is submitted
+	 *
+	 * @param job Job which should wait
+	 * @param dependency Job it should wait for
+	 */
+	MYLIB_SPEC void addDependency(Job* job, Job* dependency);
+
+	/***
+	 * @brief Lets a job run as soon as everything it depends on is finished
+	 *
+	 * @param job Job to submit
+	 */
+	MYLIB_SPEC void submit(Job* job);
+
+	/***
+	 * @brief Runs other jobs until a job is finished, so the waiting thread
+	 *			does work instead of sitting around
+	 *			Can be called from any thread, ones that aren't ours work
+	 *			through the first queue
+	 *
+	 * @param job Job to wait for
+	 */
+	MYLIB_SPEC void wait(Job* job);
+
+	/***
+	 * @brief Splits a range of indices into batches and runs them across
+	 *			every thread, returns once all of them are done
+	 *			Every index is only ever run once, so writing results into
+	 *			a slot per index gives the same results as a normal loop
+	 *
+	 * @param count Number of indices, starting from 0
+	 * @param batchSize Minimum number of indices given to a job at once
+	 * @param func Function run on each batch with its start and end index
+	 *			(end isn't included)
+	 */
+	MYLIB_SPEC void parallelFor(int count, int batchSize,
+		std::function<void(int, int)> func);
+
+	// number of threads jobs run on, including the one that made this
+	int getThreadCount() { return m_queueCount; }
+
+	/***
+	 * @brief Gets the index of the thread calling this, 0 is the thread that
+	 *			made the JobSystem
+	 *
+	 * @return Index of the thread, or -1 if it isn't one of ours
+	 */
+	MYLIB_SPEC int getThreadIndex();
+
+private:
+	struct WorkerQueue
+	{
+		std::mutex lock;
+		std::deque<Job*> jobs;
+	};
+
+	// one queue per thread, the first is for the thread that made this
+	WorkerQueue* m_queues;
+	int m_queueCount;
+
+	std::thread* m_threads;
+	int m_threadCount;
+
+	// used to put workers to sleep while there's nothing to do
+	std::mutex m_sleepLock;
+	std::condition_variable m_wake;
+	// jobs sitting in queues
+	std::atomic<int> m_queued;
+	std::atomic<bool> m_running;
+
+	void workerLoop(int index);
+
+	void push(Job* job);
+	// grabs a job from our own queue or steals one from someone else's
+	Job* findJob(int index);
+	void run(Job* job);
+	void finish(Job* job);
+};
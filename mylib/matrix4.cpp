@@ -4,6 +4,7 @@
 #include <cassert>
 
 #include "matrix3.h"
+#include "simd.h"
 
 Matrix4::Matrix4()
 {
@@ -70,23 +71,6 @@ Matrix4::Matrix4(float* values)
 			m2d[i][j] = values[i * 4 + j];
 }
 
-Matrix4::Matrix4(Matrix4 const& other)
-{
-	// copy values from other matrix's array
-	for (int i = 0; i < 4; ++i)
-		for (int j = 0; j < 4; ++j)
-			m2d[i][j] = other.m2d[i][j];
-}
-
-Matrix4& Matrix4::operator=(Matrix4 const& other)
-{
-	// copy values from other matrix's array
-	for (int i = 0; i < 4; ++i)
-		for (int j = 0; j < 4; ++j)
-			m2d[i][j] = other.m2d[i][j];
-	return *this;
-}
-
 // make all 3 rotation matrices and combine them
 void Matrix4::setRotate(Vector3 const& v)
 {
@@ -289,84 +273,84 @@ Vector3 Matrix4::getAngles()
 	return { pitch, yaw, roll };
 }
 
+// each column of the result is the columns of this matrix scaled by one
+// column of the other and added up, so a whole column is done at once
+// they're added in the same order a row at a time would be, so the results
+// don't change
+static inline Float4 multiplyColumn(Float4 const* columns, float x, float y,
+	float z, float w)
+{
+	Float4 result = float4Mul(columns[0], float4Splat(x));
+	result = float4Add(result, float4Mul(columns[1], float4Splat(y)));
+	result = float4Add(result, float4Mul(columns[2], float4Splat(z)));
+	return float4Add(result, float4Mul(columns[3], float4Splat(w)));
+}
+
 // multiply by a column vector
 Vector4 Matrix4::operator*(Vector4 const& v)
 {
-	Vector4 result;
+	Float4 columns[4];
 	for (int i = 0; i < 4; ++i)
-		result[i] = mvec[0][i] * v.x + mvec[1][i] * v.y + mvec[2][i] * v.z +
-		mvec[3][i] * v.w;
+		columns[i] = float4LoadU(m2d[i]);
+
+	Vector4 result;
+	float4StoreU(&result.x, multiplyColumn(columns, v.x, v.y, v.z, v.w));
 	return result;
 }
 
 // matrix multiplication
 Matrix4 Matrix4::operator*(Matrix4 const& other)
 {
+	Float4 columns[4];
+	for (int i = 0; i < 4; ++i)
+		columns[i] = float4LoadU(m2d[i]);
+
 	Matrix4 result;
+	for (int i = 0; i < 4; ++i)
+		float4StoreU(result.m2d[i], multiplyColumn(columns, other.m2d[i][0],
+			other.m2d[i][1], other.m2d[i][2], other.m2d[i][3]));
+	return result;
+}
 
-	// nicer looking but slower :(
-	//for (int i = 0; i < 4; ++i)
-	//	for (int j = 0; j < 4; ++j)
-	//		result.m2d[j][i] = m2d[0][i] * other.m2d[j][0] +
-	//		m2d[1][i] * other.m2d[j][1] +
-	//		m2d[2][i] * other.m2d[j][2] +
-	//		m2d[3][i] * other.m2d[j][3];
-
-	// here's 1000 lines of multiplying things
-	// how exciting
-	result.m2d[0][0] = m2d[0][0] * other.m2d[0][0] + m2d[1][0] * 
-		other.m2d[0][1] + m2d[2][0] * other.m2d[0][2] + m2d[3][0] * 
-		other.m2d[0][3];
-	result.m2d[1][0] = m2d[0][0] * other.m2d[1][0] + m2d[1][0] * 
-		other.m2d[1][1] + m2d[2][0] * other.m2d[1][2] + m2d[3][0] * 
-		other.m2d[1][3];
-	result.m2d[2][0] = m2d[0][0] * other.m2d[2][0] + m2d[1][0] * 
-		other.m2d[2][1] + m2d[2][0] * other.m2d[2][2] + m2d[3][0] * 
-		other.m2d[2][3];
-	result.m2d[3][0] = m2d[0][0] * other.m2d[3][0] + m2d[1][0] * 
-		other.m2d[3][1] + m2d[2][0] * other.m2d[3][2] + m2d[3][0] * 
-		other.m2d[3][3];
-
-	result.m2d[0][1] = m2d[0][1] * other.m2d[0][0] + m2d[1][1] * 
-		other.m2d[0][1] + m2d[2][1] * other.m2d[0][2] + m2d[3][1] * 
-		other.m2d[0][3];
-	result.m2d[1][1] = m2d[0][1] * other.m2d[1][0] + m2d[1][1] * 
-		other.m2d[1][1] + m2d[2][1] * other.m2d[1][2] + m2d[3][1] * 
-		other.m2d[1][3];
-	result.m2d[2][1] = m2d[0][1] * other.m2d[2][0] + m2d[1][1] * 
-		other.m2d[2][1] + m2d[2][1] * other.m2d[2][2] + m2d[3][1] * 
-		other.m2d[2][3];
-	result.m2d[3][1] = m2d[0][1] * other.m2d[3][0] + m2d[1][1] * 
-		other.m2d[3][1] + m2d[2][1] * other.m2d[3][2] + m2d[3][1] * 
-		other.m2d[3][3];
-
-	result.m2d[0][2] = m2d[0][2] * other.m2d[0][0] + m2d[1][2] * 
-		other.m2d[0][1] + m2d[2][2] * other.m2d[0][2] + m2d[3][2] * 
-		other.m2d[0][3];
-	result.m2d[1][2] = m2d[0][2] * other.m2d[1][0] + m2d[1][2] * 
-		other.m2d[1][1] + m2d[2][2] * other.m2d[1][2] + m2d[3][2] * 
-		other.m2d[1][3];
-	result.m2d[2][2] = m2d[0][2] * other.m2d[2][0] + m2d[1][2] * 
-		other.m2d[2][1] + m2d[2][2] * other.m2d[2][2] + m2d[3][2] * 
-		other.m2d[2][3];
-	result.m2d[3][2] = m2d[0][2] * other.m2d[3][0] + m2d[1][2] * 
-		other.m2d[3][1] + m2d[2][2] * other.m2d[3][2] + m2d[3][2] * 
-		other.m2d[3][3];
-
-	result.m2d[0][3] = m2d[0][3] * other.m2d[0][0] + m2d[1][3] * 
-		other.m2d[0][1] + m2d[2][3] * other.m2d[0][2] + m2d[3][3] * 
-		other.m2d[0][3];
-	result.m2d[1][3] = m2d[0][3] * other.m2d[1][0] + m2d[1][3] * 
-		other.m2d[1][1] + m2d[2][3] * other.m2d[1][2] + m2d[3][3] * 
-		other.m2d[1][3];
-	result.m2d[2][3] = m2d[0][3] * other.m2d[2][0] + m2d[1][3] * 
-		other.m2d[2][1] + m2d[2][3] * other.m2d[2][2] + m2d[3][3] * 
-		other.m2d[2][3];
-	result.m2d[3][3] = m2d[0][3] * other.m2d[3][0] + m2d[1][3] * 
-		other.m2d[3][1] + m2d[2][3] * other.m2d[3][2] + m2d[3][3] * 
-		other.m2d[3][3];
+void Matrix4::transformPoints(Matrix4 const& m, Vector3 const* in,
+	Vector3* out, int count)
+{
+	Float4 columns[4];
+	for (int i = 0; i < 4; ++i)
+		columns[i] = float4LoadU(m.m2d[i]);
 
-	return result;
+	// Vector3s are only 3 floats, so each result goes through here on the
+	// way out
+	alignas(16) float result[4];
+	for (int i = 0; i < count; ++i)
+	{
+		Vector3 const& p = in[i];
+		float4Store(result, multiplyColumn(columns, p.x, p.y, p.z, 1.0f));
+		out[i].x = result[0];
+		out[i].y = result[1];
+		out[i].z = result[2];
+	}
+}
+
+void Matrix4::rotatePoints(Matrix4 const& m, Vector3 const* in,
+	Vector3* out, int count)
+{
+	Float4 columns[3];
+	for (int i = 0; i < 3; ++i)
+		columns[i] = float4LoadU(m.m2d[i]);
+
+	alignas(16) float result[4];
+	for (int i = 0; i < count; ++i)
+	{
+		Vector3 const& p = in[i];
+		Float4 r = float4Mul(columns[0], float4Splat(p.x));
+		r = float4Add(r, float4Mul(columns[1], float4Splat(p.y)));
+		r = float4Add(r, float4Mul(columns[2], float4Splat(p.z)));
+		float4Store(result, r);
+		out[i].x = result[0];
+		out[i].y = result[1];
+		out[i].z = result[2];
+	}
 }
 
 // multiply each value by a float
@@ -13,6 +13,7 @@
 #include "vector3.h"
 #include "vector4.h"
 
+// not aligned, see Vector4 - columns go through unaligned SSE loads
 struct Matrix4
 {
 	/***
@@ -49,9 +50,9 @@ struct Matrix4
 	 */
 	MYLIB_SPEC explicit Matrix4(float* values);
 
-	// copy constructors
-	MYLIB_SPEC Matrix4(Matrix4 const& other);
-	MYLIB_SPEC Matrix4& operator=(Matrix4 const& other);
+	// copying is just copying the 16 floats, so the compiler can do it
+	MYLIB_SPEC Matrix4(Matrix4 const& other) = default;
+	MYLIB_SPEC Matrix4& operator=(Matrix4 const& other) = default;
 
 	/***
 	 * @brief Makes a rotation matrix by combining x, y and z rotation matrices
@@ -190,6 +191,26 @@ struct Matrix4
 	 * @return A new matrix with each element multiplied by f
 	 */
 	MYLIB_SPEC Matrix4 operator*(float f);
+
+	/***
+	 * @brief Transforms a whole list of points by a matrix at once, which is
+	 *			much quicker than multiplying them one at a time
+	 *			Gives exactly the same results as multiplying each point as
+	 *			a Vector4 with a w of 1
+	 *
+	 * @param m Matrix to transform the points by
+	 * @param in Points to transform
+	 * @param out Where the transformed points go, can be the same as in
+	 * @param count Number of points
+	 */
+	MYLIB_SPEC static void transformPoints(Matrix4 const& m, 
+		Vector3 const* in, Vector3* out, int count);
+	/***
+	 * @brief Same as transformPoints, but ignores the matrix's position
+	 *			(like multiplying with a w of 0), for directions and normals
+	 */
+	MYLIB_SPEC static void rotatePoints(Matrix4 const& m, 
+		Vector3 const* in, Vector3* out, int count);
 	/***
 	 * @brief Allows casting to a float pointer to use with the bootstrap
 	 */
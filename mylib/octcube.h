@@ -0,0 +1,23 @@
+#pragma once
+
+// axis-aligned box used by the octree and the other broadphase structures
+struct OctCube
+{
+	float minX, minY, minZ;
+	float maxX, maxY, maxZ;
+};
+
+/***
+ * @brief Checks if two boxes overlap, touching counts as overlapping
+ *
+ * @param a First box
+ * @param b Second box
+ * @return Whether or not the boxes overlap
+ */
+inline bool cubesIntersect(OctCube const& a, OctCube const& b)
+{
+	// if any of these are true, we're NOT colliding
+	return !(a.minX > b.maxX || a.maxX < b.minX ||
+		a.minY > b.maxY || a.maxY < b.minY ||
+		a.minZ > b.maxZ || a.maxZ < b.minZ);
+}
@@ -1,23 +1,23 @@
 #pragma once
 
 #include "darray.h"
+#include "octcube.h"
 
 // forward declare so we can make a pointer in OctObject
 template <class T>
 class Octree;
 
-struct OctCube
-{
-	float minX, minY, minZ;
-	float maxX, maxY, maxZ;
-};
-
 template <class T>
 struct OctObject
 {
 	T data;
 	OctCube volume;
+	// tree the object was put into, which owns it (and reuses it once the
+	// tree's cleared)
 	Octree<T>* parent;
+	// last query that found this object, objects can be in more than one
+	// tree so this stops them being found more than once by the same query
+	unsigned int queryStamp;
 };
 
 template <class T>
@@ -25,15 +25,15 @@ class Octree
 {
 public:
 	Octree(int density, OctCube const& bounds)
-		: m_density(density), m_bounds(bounds)
+		: m_density(density)
 	{
 		m_divided = false;
+		m_root = this;
+		m_usedObjects = 0;
+		m_usedNodes = 0;
+		m_queryStamp = 0;
 
-		// this tree isn't dividable (divisible?) if it gets small enough
-		// - stops an eventual stack overflow when trees get tiny
-		const float dividableLimit = 0.2f;
-		m_dividable = bounds.maxX - bounds.minX >= dividableLimit &&
-			bounds.maxY - bounds.minY >= dividableLimit;
+		setBounds(bounds);
 	}
 
 	Octree(int density, float minX, float minY, float minZ,
@@ -44,68 +44,58 @@ public:
 
 	~Octree()
 	{
-		if (m_divided)
-			for (int i = 0; i < 8; ++i)
-				delete m_children[i];
-
-		for (int i = 0; i < m_objects.getCount(); ++i)
-			delete m_objects[i];
-		m_objects.clear();
+		// only the root has anything pooled, child trees are all in there
+		for (int i = 0; i < m_nodePool.getCount(); ++i)
+			delete m_nodePool[i];
+		for (int i = 0; i < m_objectPool.getCount(); ++i)
+			delete m_objectPool[i];
 	}
 
+	// not copyable, the pooled trees and objects would be deleted twice
+	Octree(Octree const&) = delete;
+	Octree& operator=(Octree const&) = delete;
+
 	/***
 	 * @brief Puts an object into the tree, passing it into child trees if
 	 *			possible
+	 *			Objects bigger than a child tree are kept in this one instead,
+	 *			otherwise something like a floor would end up in nearly every
+	 *			tree and be found by nearly every query
 	 *
 	 * @param object Object to put into the tree
 	 * @param vol Bounding box of this object
 	 */
 	void insert(T object, OctCube const& vol)
 	{
-		if ((m_divided || m_objects.getCount() >= m_density)
-			&& m_dividable)
-		{
-			if (!m_divided)
-				split();
-
-			// pass it to all relevant segments
-			// (not just one, so large objects get added to every tree they
-			//		touch)
-			for (int i = 0; i < 8; ++i)
-			{
-				Octree<T>* child = m_children[i];
-				if (child->intersects(vol))
-					child->insert(object, vol);
-			}
-		}
-		else
-		{
-			// not divided, so the object can go in this node
-
-			// make an OctObject for this object
-			auto obj = new OctObject<T>();
-			obj->data = object;
-			obj->volume = vol;
-			obj->parent = this;
-
-			// stick it into the array
-			m_objects.add(obj);
-		}
+		// grab an OctObject for this object, which every tree it goes into
+		// shares
+		OctObject<T>* obj = m_root->makeObject();
+		obj->data = object;
+		obj->volume = vol;
+		obj->parent = m_root;
+
+		insertObject(obj);
 	}
 
 	/***
 	 * @brief Removes all objects and child trees from this tree
+	 *			Nothing is actually deleted, the root keeps it all to reuse
+	 *			the next time the tree's filled, so a tree that's cleared and
+	 *			filled back up every frame stops allocating once it's grown
+	 *			big enough
 	 */
 	void clear()
 	{
-		if (m_divided)
-			for (int i = 0; i < 8; ++i)
-				delete m_children[i];
-		for (int i = 0; i < m_objects.getCount(); ++i)
-			delete m_objects[i];
 		m_objects.clear();
-
 		m_divided = false;
+
+		// only the root actually owns any objects or child trees, and they
+		// can only be reused once they're all out of the tree
+		if (m_root == this)
+		{
+			m_usedObjects = 0;
+			m_usedNodes = 0;
+		}
 	}
 
 	/***
@@ -124,6 +114,33 @@ public:
 		return true;
 	}
 
+	/***
+	 * @brief Calls a function on every object whose own box intersects a
+	 *			range, once each
+	 *			Queries mark the objects they find, so only one can be run
+	 *			on a tree at a time
+	 *
+	 * @param range Bounding box to check for intersection
+	 * @param func Function taking each object that's found
+	 */
+	template <class F>
+	void visit(OctCube const& range, F func)
+	{
+		visit(range, nextQueryStamp(), func);
+	}
+
+	/***
+	 * @brief Gets every object whose own box intersects a range, without
+	 *			allocating anything once the list is big enough
+	 *
+	 * @param range Bounding box to check for intersection
+	 * @param list Array the objects are added onto
+	 */
+	void query(OctCube const& range, DArray<T>& list)
+	{
+		visit(range, [&list](T object) { list.add(object); });
+	}
+
 	/***
 	 * @brief Gets all objects in all trees that intersect with a box
 	 *
@@ -133,7 +150,7 @@ public:
 	DArray<T> getInRange(OctCube const& range)
 	{
 		DArray<T> result;
-		getInRange(range, &result);
+		query(range, result);
 		return result;
 	}
 
@@ -164,14 +181,140 @@ private:
 	// bounding box of this tree
 	OctCube m_bounds;
 
+	// every object if this tree hasn't split, otherwise just the ones that
+	// were too big to go into any child tree
+	// these are shared with any other trees the objects are in
 	DArray<OctObject<T>*> m_objects;
 
+	// tree at the top, which owns every object and child tree and keeps the
+	// query stamp
+	Octree* m_root;
+	// every object that's ever been made for the tree, the first
+	// m_usedObjects are in it right now and the rest are free to be reused
+	// only used by the root
+	DArray<OctObject<T>*> m_objectPool;
+	int m_usedObjects;
+	// same for child trees
+	// they're handed out in the same order every time, so a tree that's
+	// filled the same way gets the same child trees in the same places, and
+	// their arrays are already big enough
+	DArray<Octree*> m_nodePool;
+	int m_usedNodes;
+	// stamp given to the last query, only used by the root
+	unsigned int m_queryStamp;
+
 	// has this tree split
 	bool m_divided;
 	// is this tree large enough to split
 	bool m_dividable;
 	Octree* m_children[8];
 
+	/***
+	 * @brief Changes the area this tree covers
+	 *
+	 * @param bounds Bounding box of this tree
+	 */
+	void setBounds(OctCube const& bounds)
+	{
+		m_bounds = bounds;
+
+		// this tree isn't dividable (divisible?) if it gets small enough
+		// - stops an eventual stack overflow when trees get tiny
+		const float dividableLimit = 0.2f;
+		m_dividable = bounds.maxX - bounds.minX >= dividableLimit &&
+			bounds.maxY - bounds.minY >= dividableLimit;
+	}
+
+	/***
+	 * @brief Gets an unused object from the pool, making one if they're all
+	 *			being used
+	 *			Only called on the root
+	 *
+	 * @return The object
+	 */
+	OctObject<T>* makeObject()
+	{
+		if (m_usedObjects == m_objectPool.getCount())
+			m_objectPool.add(new OctObject<T>());
+
+		OctObject<T>* obj = m_objectPool[m_usedObjects++];
+		obj->queryStamp = 0;
+		return obj;
+	}
+
+	/***
+	 * @brief Gets an unused child tree from the pool, making one if they're
+	 *			all being used
+	 *			Only called on the root
+	 *
+	 * @param bounds Bounding box of the child tree
+	 * @return The child tree, which is empty
+	 */
+	Octree* makeNode(OctCube const& bounds)
+	{
+		if (m_usedNodes == m_nodePool.getCount())
+			m_nodePool.add(new Octree<T>(m_density, bounds));
+
+		Octree* node = m_nodePool[m_usedNodes++];
+		node->m_root = this;
+		node->setBounds(bounds);
+		// clearing keeps the array's memory from last time
+		node->m_objects.clear();
+		node->m_divided = false;
+		return node;
+	}
+
+	/***
+	 * @brief Puts an object into this tree or its children
+	 *
+	 * @param obj Object to put into the tree
+	 */
+	void insertObject(OctObject<T>* obj)
+	{
+		if ((m_divided || m_objects.getCount() >= m_density)
+			&& m_dividable)
+		{
+			if (!m_divided)
+				split();
+
+			if (!fitsInChild(obj->volume))
+			{
+				m_objects.add(obj);
+				return;
+			}
+
+			// pass it to all relevant segments
+			// (not just one, so objects on the edge of a segment get added
+			//		to every tree they touch, it's no bigger than a segment
+			//		so that's 8 at most)
+			for (int i = 0; i < 8; ++i)
+			{
+				Octree<T>* child = m_children[i];
+				if (child->intersects(obj->volume))
+					child->insertObject(obj);
+			}
+		}
+		else
+		{
+			// not divided, so the object can go in this node
+			m_objects.add(obj);
+		}
+	}
+
+	/***
+	 * @brief Checks if a box is small enough to go into a child tree, which
+	 *			is half the size of this one along every axis
+	 *
+	 * @param vol Bounding box to check
+	 * @return Whether or not it's no bigger than a child tree
+	 */
+	bool fitsInChild(OctCube const& vol)
+	{
+		return vol.maxX - vol.minX <= (m_bounds.maxX - m_bounds.minX) / 2.0f &&
+			vol.maxY - vol.minY <= (m_bounds.maxY - m_bounds.minY) / 2.0f &&
+			vol.maxZ - vol.minZ <= (m_bounds.maxZ - m_bounds.minZ) / 2.0f;
+	}
+
 	/***
 	 * @brief Splits this tree into 8 equal-sized child trees
 	 */
@@ -200,7 +343,7 @@ private:
 					bounds.maxY = bounds.minY + height;
 					bounds.maxZ = bounds.minZ + depth;
 
-					m_children[childIndex] = new Octree<T>(m_density, bounds);
+					m_children[childIndex] = m_root->makeNode(bounds);
 
 					childIndex++;
 				}
@@ -208,61 +351,83 @@ private:
 		}
 		m_divided = true;
 
-		// move objects into children
+		// move objects into children, apart from any that are too big
+		int kept = 0;
 		for (int i = 0; i < m_objects.getCount(); ++i)
 		{
+			OctObject<T>* obj = m_objects[i];
+			if (!fitsInChild(obj->volume))
+			{
+				m_objects[kept++] = obj;
+				continue;
+			}
+
 			// check each child tree to see if this object intersects
 			for (int j = 0; j < 8; ++j)
 			{
 				Octree<T>* child = m_children[j];
 				// and insert it if it does
-				if (child->intersects(m_objects[i]->volume))
-					child->insert(m_objects[i]->data, m_objects[i]->volume);
+				if (child->intersects(obj->volume))
+					child->insertObject(obj);
 			}
-			// we can delete this since we're creating new objects in insert
-			delete m_objects[i];
 		}
-		// all the objects have (hopefully) been passed onto our children
-		m_objects.clear();
+		// everything else has (hopefully) been passed onto our children
+		while (m_objects.getCount() > kept)
+			m_objects.pop();
+	}
+
+	/***
+	 * @brief Gets a stamp for a new query that no object has yet
+	 *
+	 * @return The stamp
+	 */
+	unsigned int nextQueryStamp()
+	{
+		// once the stamp wraps around, objects could already have the new
+		// one from ages ago, so start them all again
+		if (++m_root->m_queryStamp == 0)
+		{
+			for (int i = 0; i < m_root->m_objectPool.getCount(); ++i)
+				m_root->m_objectPool[i]->queryStamp = 0;
+			m_root->m_queryStamp = 1;
+		}
+		return m_root->m_queryStamp;
 	}
 
 	/***
-	 * @brief Recursively adds items into a list from child trees that
-	 *			intersect with a box
+	 * @brief Recursively calls a function on objects in trees that
+	 *			intersect with a box, skipping any this query's already been
+	 *			to
 	 *
 	 * @param cube Box to check for intersections with
-	 * @param list Pointer to a dynamic array to add objects to
+	 * @param stamp Stamp of this query
+	 * @param func Function taking each object that's found
 	 */
-	void getInRange(OctCube const& cube, DArray<T>* list)
+	template <class F>
+	void visit(OctCube const& cube, unsigned int stamp, F& func)
 	{
 		// if this doesn't intersect with this cube, none of our children would
 		//	either, so we can leave
 		if (!intersects(cube))
 			return;
 
+		for (int i = 0; i < m_objects.getCount(); ++i)
+		{
+			OctObject<T>* obj = m_objects[i];
+			if (obj->queryStamp == stamp)
+				continue;
+			obj->queryStamp = stamp;
+
+			// the tree touching the cube doesn't mean the object does
+			if (cubesIntersect(obj->volume, cube))
+				func(obj->data);
+		}
+
 		if (m_divided)
 		{
 			// call this on all our children
 			for (int i = 0; i < 8; ++i)
-				m_children[i]->getInRange(cube, list);
-		}
-		else
-		{
-			// only add objects which aren't already in the list
-			for (int i = 0; i < m_objects.getCount(); ++i)
-			{
-				bool wasInList = false;
-				for (int j = 0; j < list->getCount(); ++j)
-				{
-					if (m_objects[i]->data == (*list)[j])
-					{
-						wasInList = true;
-						break;
-					}
-				}
-				if (!wasInList)
-					list->add(m_objects[i]->data);
-			}
+				m_children[i]->visit(cube, stamp, func);
 		}
 	}
-};
\ No newline at end of file
+};
@@ -31,6 +31,9 @@ public:
 		: m_density(density), m_bounds(bounds)
 	{
 		m_divided = false;
+		m_root = this;
+		m_usedObjects = 0;
+		m_usedNodes = 0;
 	}
 	QuadTree(int density, float minX, float minY, float maxX, float maxY)
 		: QuadTree(density, { minX, minY, maxX, maxY })
@@ -39,18 +42,17 @@ public:
 
 	~QuadTree()
 	{
-		if (m_divided)
-		{
-			for (int i = 0; i < 4; ++i)
-				delete m_children[i];
-			return;
-		}
-
-		for (int i = 0; i < m_objects.getCount(); ++i)
-			delete m_objects[i];
-		m_objects.clear();
+		// only the root has anything pooled, child segments are all in there
+		for (int i = 0; i < m_nodePool.getCount(); ++i)
+			delete m_nodePool[i];
+		for (int i = 0; i < m_objectPool.getCount(); ++i)
+			delete m_objectPool[i];
 	}
 
+	// not copyable, the pooled trees and objects would be deleted twice
+	QuadTree(QuadTree const&) = delete;
+	QuadTree& operator=(QuadTree const&) = delete;
+
     /***
      *  @brief Puts an object into the quadtree with an associated position
 	 *
@@ -59,32 +61,12 @@ public:
      */
 	void insert(T object, Vector2 const& position)
 	{
-        // pass the object to children if they exist OR create children
-        // if this segment is full
-		if (isDivided() || m_objects.getCount() >= m_density)
-		{
-			if (!isDivided())
-				split();
+		// grab a QuadObject for the parameters, the root keeps them all
+		QuadObject<T>* obj = m_root->makeObject();
+		obj->data = object;
+		obj->pos = position;
 
-            // find the segment to pass it to
-			for (int i = 0; i < 4; ++i)
-			{
-				if (m_children[i]->isInside(position))
-				{
-					m_children[i]->insert(object, position);
-					break;
-				}
-			}
-		}
-		else
-		{
-			// make a QuadObject from the parameters
-			auto obj = new QuadObject<T>();
-			obj->data = object;
-			obj->pos = position;
-            // and stick it into this segment
-			put(obj);
-		}
+		insertObject(obj);
 	}
 
     /***
@@ -124,25 +106,29 @@ public:
      */
 	bool isInside(Vector2 const& p)
 	{
-		return p.getX() > m_bounds.minX && p.getY() > m_bounds.minY &&
-			p.getX() <= m_bounds.maxX && p.getY() <= m_bounds.maxY;
+		return p.x > m_bounds.minX && p.y > m_bounds.minY &&
+			p.x <= m_bounds.maxX && p.y <= m_bounds.maxY;
 	}
 
     /***
      *  @brief Remove all objects from this segment and its children
-     *          and also delete the children
+     *          and also get rid of the children
+     *          Nothing is actually deleted, the root keeps it all to reuse
+     *          the next time the tree's filled, so it stops allocating once
+     *          it's grown big enough
      */
 	void clear()
 	{
-		// get rid of all children and objects in those children
-		if (m_divided)
-			for (int i = 0; i < 4; ++i)
-				delete m_children[i];
-		for (int i = 0; i < m_objects.getCount(); ++i)
-			delete m_objects[i];
 		m_objects.clear();
-
 		m_divided = false;
+
+		// only the root owns any objects or child segments, and they can
+		// only be reused once they're all out of the tree
+		if (m_root == this)
+		{
+			m_usedObjects = 0;
+			m_usedNodes = 0;
+		}
 	}
 
     /***
@@ -189,9 +175,89 @@ private:
 
 	DArray<QuadObject<T>*> m_objects;
 
+	// tree at the top, which owns every object and child tree
+	QuadTree* m_root;
+	// every object that's ever been made for the tree, the first
+	// m_usedObjects are in it right now and the rest are free to be reused
+	// only used by the root
+	DArray<QuadObject<T>*> m_objectPool;
+	int m_usedObjects;
+	// same for child segments, handed out in the same order every time so a
+	// tree that's filled the same way gets the same ones in the same places
+	DArray<QuadTree*> m_nodePool;
+	int m_usedNodes;
+
 	bool m_divided;
 	QuadTree* m_children[4];
 
+    /***
+     *  @brief Passes an object down to whichever segment it's in, splitting
+     *          this one if it's full
+	 *
+     *  @param obj Object to put into the tree
+     */
+	void insertObject(QuadObject<T>* obj)
+	{
+        // pass the object to children if they exist OR create children
+        // if this segment is full
+		if (isDivided() || m_objects.getCount() >= m_density)
+		{
+			if (!isDivided())
+				split();
+
+            // find the segment to pass it to
+			for (int i = 0; i < 4; ++i)
+			{
+				if (m_children[i]->isInside(obj->pos))
+				{
+					m_children[i]->insertObject(obj);
+					break;
+				}
+			}
+		}
+		else
+		{
+            // stick it into this segment
+			put(obj);
+		}
+	}
+
+    /***
+     *  @brief Gets an unused object from the pool, making one if they're
+     *          all being used
+     *          Only called on the root
+	 *
+     *  @return The object
+     */
+	QuadObject<T>* makeObject()
+	{
+		if (m_usedObjects == m_objectPool.getCount())
+			m_objectPool.add(new QuadObject<T>());
+		return m_objectPool[m_usedObjects++];
+	}
+
+    /***
+     *  @brief Gets an unused segment from the pool, making one if they're
+     *          all being used
+     *          Only called on the root
+	 *
+     *  @param bounds Bounds of the segment
+     *  @return The segment, which is empty
+     */
+	QuadTree* makeNode(QuadRect const& bounds)
+	{
+		if (m_usedNodes == m_nodePool.getCount())
+			m_nodePool.add(new QuadTree<T>(m_density, bounds));
+
+		QuadTree* node = m_nodePool[m_usedNodes++];
+		node->m_root = this;
+		node->m_bounds = bounds;
+		// clearing keeps the array's memory from last time
+		node->m_objects.clear();
+		node->m_divided = false;
+		return node;
+	}
+
     /***
      *  @brief Divides this tree into four, and passes any objects into those
      *          children
@@ -214,34 +280,26 @@ private:
 		QuadRect bounds3 = { left, bottom + height / 2, left + width / 2, bottom + height };
 
 		// make our new children
-		m_children[0] = new QuadTree<T>(m_density, bounds0);
-		m_children[1] = new QuadTree<T>(m_density, bounds1);
-		m_children[2] = new QuadTree<T>(m_density, bounds2);
-		m_children[3] = new QuadTree<T>(m_density, bounds3);
+		m_children[0] = m_root->makeNode(bounds0);
+		m_children[1] = m_root->makeNode(bounds1);
+		m_children[2] = m_root->makeNode(bounds2);
+		m_children[3] = m_root->makeNode(bounds3);
 
 		m_divided = true;
 
 		// move all the objects in this into our children
-		/*for (int i = 0; i < m_objects.getCount(); ++i)
+		// the root owns them, so they can just be passed down as they are
+		for (int i = 0; i < m_objects.getCount(); ++i)
 		{
 			auto obj = m_objects[i];
 			for (int j = 0; j < 4; ++j)
 			{
 				if (m_children[j]->isInside(obj->pos))
 				{
-					obj->parent = m_children[j];
-					m_children[j]->put(obj);
+					m_children[j]->insertObject(obj);
 					break;
 				}
 			}
-		}*/
-
-		// instead of moving the objects efficiently, just insert new ones
-		// the other way has a memory leak and I'm too dumb to find it
-		for (int i = 0; i < m_objects.getCount(); ++i)
-		{
-			insert(m_objects[i]->data, m_objects[i]->pos);
-			delete m_objects[i];
 		}
 		m_objects.clear();
 	}
@@ -0,0 +1,161 @@
+#include "quaternion.h"
+
+#include <cmath>
+
+#include "matrix4.h"
+
+Quaternion::Quaternion()
+	: x(0), y(0), z(0), w(1) { }
+
+Quaternion::Quaternion(float x, float y, float z, float w)
+	: x(x), y(y), z(z), w(w) { }
+
+Quaternion Quaternion::fromAxisAngle(Vector3 const& axis, float angle)
+{
+	float s = sinf(angle * 0.5f);
+	return Quaternion(axis.x * s, axis.y * s, axis.z * s, cosf(angle * 0.5f));
+}
+
+Quaternion Quaternion::fromEuler(Vector3 const& angles)
+{
+	// setRotate does x * y * z, so the z rotation happens first
+	return fromAxisAngle(Vector3(1.0f, 0.0f, 0.0f), angles.x) *
+		fromAxisAngle(Vector3(0.0f, 1.0f, 0.0f), angles.y) *
+		fromAxisAngle(Vector3(0.0f, 0.0f, 1.0f), angles.z);
+}
+
+Quaternion Quaternion::fromMatrix(Matrix4 const& m)
+{
+	// m2d is column then row, these are named row then column
+	float m00 = m.m2d[0][0], m01 = m.m2d[1][0], m02 = m.m2d[2][0];
+	float m10 = m.m2d[0][1], m11 = m.m2d[1][1], m12 = m.m2d[2][1];
+	float m20 = m.m2d[0][2], m21 = m.m2d[1][2], m22 = m.m2d[2][2];
+
+	// work out whichever value is biggest first and the rest from it, so
+	// there's never a divide by something tiny
+	Quaternion q;
+	float trace = m00 + m11 + m22;
+	if (trace > 0.0f)
+	{
+		float s = sqrtf(trace + 1.0f) * 2.0f;
+		q.w = 0.25f * s;
+		q.x = (m21 - m12) / s;
+		q.y = (m02 - m20) / s;
+		q.z = (m10 - m01) / s;
+	}
+	else if (m00 > m11 && m00 > m22)
+	{
+		float s = sqrtf(1.0f + m00 - m11 - m22) * 2.0f;
+		q.w = (m21 - m12) / s;
+		q.x = 0.25f * s;
+		q.y = (m01 + m10) / s;
+		q.z = (m02 + m20) / s;
+	}
+	else if (m11 > m22)
+	{
+		float s = sqrtf(1.0f + m11 - m00 - m22) * 2.0f;
+		q.w = (m02 - m20) / s;
+		q.x = (m01 + m10) / s;
+		q.y = 0.25f * s;
+		q.z = (m12 + m21) / s;
+	}
+	else
+	{
+		float s = sqrtf(1.0f + m22 - m00 - m11) * 2.0f;
+		q.w = (m10 - m01) / s;
+		q.x = (m02 + m20) / s;
+		q.y = (m12 + m21) / s;
+		q.z = 0.25f * s;
+	}
+	q.normalise();
+	return q;
+}
+
+Vector3 Quaternion::rotate(Vector3 const& v) const
+{
+	// v + 2w(q x v) + 2q x (q x v), with the 2s folded into t
+	Vector3 q(x, y, z);
+	Vector3 t = q.cross(v) * 2.0f;
+	Vector3 result = q.cross(t);
+	result += t * w;
+	result += v;
+	return result;
+}
+
+Vector3 Quaternion::inverseRotate(Vector3 const& v) const
+{
+	return inverse().rotate(v);
+}
+
+Quaternion Quaternion::inverse() const
+{
+	return Quaternion(-x, -y, -z, w);
+}
+
+void Quaternion::normalise()
+{
+	float mag = sqrtf(x * x + y * y + z * z + w * w);
+	x /= mag;
+	y /= mag;
+	z /= mag;
+	w /= mag;
+}
+
+void Quaternion::integrate(Vector3 const& angularVelocity, float delta)
+{
+	float speed = angularVelocity.magnitude();
+	if (speed == 0.0f)
+		return;
+
+	// spin around the velocity's axis by however far it got, added on the
+	// right so it's in our own space
+	Vector3 axis = angularVelocity;
+	axis *= 1.0f / speed;
+	*this = *this * fromAxisAngle(axis, speed * delta);
+	normalise();
+}
+
+Quaternion Quaternion::lerpBetween(Quaternion const& a, Quaternion const& b,
+	float t)
+{
+	// q and -q are the same rotation, so flip b if it's the long way round
+	float dot = a.x * b.x + a.y * b.y + a.z * b.z + a.w * b.w;
+	float bt = dot < 0.0f ? -t : t;
+	float at = 1.0f - t;
+
+	Quaternion result(a.x * at + b.x * bt, a.y * at + b.y * bt,
+		a.z * at + b.z * bt, a.w * at + b.w * bt);
+	result.normalise();
+	return result;
+}
+
+Matrix4 Quaternion::toMatrix() const
+{
+	float xx = x * x, yy = y * y, zz = z * z;
+	float xy = x * y, xz = x * z, yz = y * z;
+	float wx = w * x, wy = w * y, wz = w * z;
+
+	// each column is where that axis ends up after rotating
+	Matrix4 m;
+	m.m2d[0][0] = 1.0f - 2.0f * (yy + zz);
+	m.m2d[0][1] = 2.0f * (xy + wz);
+	m.m2d[0][2] = 2.0f * (xz - wy);
+
+	m.m2d[1][0] = 2.0f * (xy - wz);
+	m.m2d[1][1] = 1.0f - 2.0f * (xx + zz);
+	m.m2d[1][2] = 2.0f * (yz + wx);
+
+	m.m2d[2][0] = 2.0f * (xz + wy);
+	m.m2d[2][1] = 2.0f * (yz - wx);
+	m.m2d[2][2] = 1.0f - 2.0f * (xx + yy);
+	return m;
+}
+
+Quaternion Quaternion::operator*(Quaternion const& o) const
+{
+	return Quaternion(
+		w * o.x + x * o.w + y * o.z - z * o.y,
+		w * o.y - x * o.z + y * o.w + z * o.x,
+		w * o.z + x * o.y - y * o.x + z * o.w,
+		w * o.w - x * o.x - y * o.y - z * o.z);
+}
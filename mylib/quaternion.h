@@ -0,0 +1,134 @@
+#pragma once
+/*
+Quaternion - Rotation in 3D
+Takes up 4 floats instead of a matrix's 16 (or 9), combining two is 16
+multiplies instead of 64, and turning it by a little bit each step can't
+slowly skew it the way it skews a matrix since it just gets normalised
+*/
+
+#ifdef MYLIB_DYNAMIC
+	#ifdef MYLIB_EXPORT
+		#define MYLIB_SPEC __declspec(dllexport)
+	#else
+		#define MYLIB_SPEC __declspec(dllimport)
+	#endif
+#else
+	#define MYLIB_SPEC
+#endif
+
+#include "vector3.h"
+
+struct Matrix4;
+
+struct Quaternion
+{
+	/***
+	 * @brief Makes a quaternion that doesn't rotate anything
+	 */
+	MYLIB_SPEC Quaternion();
+	/***
+	 * @brief Makes a quaternion with a set of values
+	 *			Should be normalised to actually be a rotation
+	 */
+	MYLIB_SPEC Quaternion(float x, float y, float z, float w);
+
+	/***
+	 * @brief Makes a rotation around an axis
+	 *
+	 * @param axis Axis to rotate around, has to be normalised
+	 * @param angle Angle to rotate by in radians
+	 * @return The rotation
+	 */
+	MYLIB_SPEC static Quaternion fromAxisAngle(Vector3 const& axis,
+		float angle);
+	/***
+	 * @brief Makes the same rotation as Matrix4::setRotate does with a set
+	 *			of angles
+	 *
+	 * @param angles Angles around the x, y and z axes in radians
+	 * @return The rotation
+	 */
+	MYLIB_SPEC static Quaternion fromEuler(Vector3 const& angles);
+	/***
+	 * @brief Gets the rotation out of a matrix
+	 *
+	 * @param m Matrix to get the rotation from, shouldn't have any scale
+	 * @return The rotation
+	 */
+	MYLIB_SPEC static Quaternion fromMatrix(Matrix4 const& m);
+
+	/***
+	 * @brief Rotates a vector by this rotation
+	 *
+	 * @param v Vector to rotate
+	 * @return The rotated vector
+	 */
+	MYLIB_SPEC Vector3 rotate(Vector3 const& v) const;
+	/***
+	 * @brief Rotates a vector by the opposite of this rotation
+	 *
+	 * @param v Vector to rotate
+	 * @return The rotated vector
+	 */
+	MYLIB_SPEC Vector3 inverseRotate(Vector3 const& v) const;
+
+	/***
+	 * @brief Gets the opposite rotation, which is just the conjugate since
+	 *			it's normalised
+	 *
+	 * @return A new quaternion that undoes this one
+	 */
+	MYLIB_SPEC Quaternion inverse() const;
+
+	/***
+	 * @brief Makes the quaternion length 1 again, after floating point
+	 *			error has slowly built up
+	 */
+	MYLIB_SPEC void normalise();
+
+	/***
+	 * @brief Turns this rotation by an angular velocity over some amount of
+	 *			time, in its own space (so velocity around y spins around
+	 *			whatever way is up for this rotation)
+	 *
+	 * @param angularVelocity Axis to spin around scaled by the speed, in
+	 *			radians per second
+	 * @param delta How long it spins for
+	 */
+	MYLIB_SPEC void integrate(Vector3 const& angularVelocity, float delta);
+
+	/***
+	 * @brief Blends between two rotations, going the short way around
+	 *			This is a normalised lerp, which doesn't turn at a perfectly
+	 *			even speed like a slerp but is close enough for small turns
+	 *			and doesn't need any trig
+	 *
+	 * @param a Starting rotation
+	 * @param b Target rotation
+	 * @param t Percentage of the way through the lerp (from 0..1)
+	 * @return The blended rotation
+	 */
+	MYLIB_SPEC static Quaternion lerpBetween(Quaternion const& a,
+		Quaternion const& b, float t);
+
+	/***
+	 * @brief Makes a rotation matrix of this rotation, with no position
+	 *
+	 * @return The rotation matrix
+	 */
+	MYLIB_SPEC Matrix4 toMatrix() const;
+
+	/***
+	 * @brief Combines two rotations, the result rotates by other and then
+	 *			by this (the same order as multiplying matrices)
+	 *
+	 * @param other Rotation to do first
+	 * @return The combined rotation
+	 */
+	MYLIB_SPEC Quaternion operator*(Quaternion const& other) const;
+
+	float x;
+	float y;
+	float z;
+	float w;
+};
@@ -0,0 +1,95 @@
+#pragma once
+/*
+SIMD - Maths on 4 floats at once
+Uses SSE when the compiler has it and plain floats when it doesn't, so
+anything written with these works everywhere and gives the same answers
+either way (there's no fused multiply-add, every multiply and add is
+rounded on its own just like the float version)
+
+	Float4 a = float4LoadU(column);
+	Float4 b = float4Splat(2.0f);
+	float4StoreU(out, float4Add(a, float4Mul(a, b)));
+*/
+
+// x64 always has SSE2, 32-bit builds only if they've been told to use it
+#if defined(__SSE2__) || defined(_M_X64) || \
+	(defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+	#define MYLIB_SSE
+	#include <emmintrin.h>
+#endif
+
+#ifdef MYLIB_SSE
+
+typedef __m128 Float4;
+
+// loads 4 floats from memory lined up to 16 bytes (stack arrays marked
+// alignas, not anything that might have come from new)
+inline Float4 float4Load(const float* p) { return _mm_load_ps(p); }
+// loads 4 floats from anywhere
+inline Float4 float4LoadU(const float* p) { return _mm_loadu_ps(p); }
+// stores 4 floats to memory lined up to 16 bytes
+inline void float4Store(float* p, Float4 v) { _mm_store_ps(p, v); }
+inline void float4StoreU(float* p, Float4 v) { _mm_storeu_ps(p, v); }
+// all 4 floats set to the same value
+inline Float4 float4Splat(float f) { return _mm_set1_ps(f); }
+
+inline Float4 float4Add(Float4 a, Float4 b) { return _mm_add_ps(a, b); }
+inline Float4 float4Sub(Float4 a, Float4 b) { return _mm_sub_ps(a, b); }
+inline Float4 float4Mul(Float4 a, Float4 b) { return _mm_mul_ps(a, b); }
+inline Float4 float4Div(Float4 a, Float4 b) { return _mm_div_ps(a, b); }
+
+#else
+
+struct Float4
+{
+	float v[4];
+};
+
+inline Float4 float4Load(const float* p)
+{
+	Float4 r;
+	for (int i = 0; i < 4; ++i)
+		r.v[i] = p[i];
+	return r;
+}
+inline Float4 float4LoadU(const float* p) { return float4Load(p); }
+inline void float4Store(float* p, Float4 v)
+{
+	for (int i = 0; i < 4; ++i)
+		p[i] = v.v[i];
+}
+inline void float4StoreU(float* p, Float4 v) { float4Store(p, v); }
+inline Float4 float4Splat(float f)
+{
+	Float4 r;
+	for (int i = 0; i < 4; ++i)
+		r.v[i] = f;
+	return r;
+}
+
+inline Float4 float4Add(Float4 a, Float4 b)
+{
+	for (int i = 0; i < 4; ++i)
+		a.v[i] += b.v[i];
+	return a;
+}
+inline Float4 float4Sub(Float4 a, Float4 b)
+{
+	for (int i = 0; i < 4; ++i)
+		a.v[i] -= b.v[i];
+	return a;
+}
+inline Float4 float4Mul(Float4 a, Float4 b)
+{
+	for (int i = 0; i < 4; ++i)
+		a.v[i] *= b.v[i];
+	return a;
+}
+inline Float4 float4Div(Float4 a, Float4 b)
+{
+	for (int i = 0; i < 4; ++i)
+		a.v[i] /= b.v[i];
+	return a;
+}
+
+#endif
@@ -0,0 +1,551 @@
+#pragma once
+/*
+SweepAndPrune - Incremental sort and sweep broadphase
+Keeps the min/max of every box sorted along each axis between updates, so
+objects that barely move only cost a couple of comparisons. Overlapping pairs
+are found while sorting, whenever one box's endpoint passes another's, and
+kept in a hash set so adding and removing them doesn't depend on how many
+pairs there are
+
+Like AABBTree, the sorted boxes are a bit bigger ("fat") than the objects,
+and only re-sorted once an object leaves its fat box. Without that, a pile
+of objects resting at the same height jitters past each other's endpoints
+along the up axis every update
+
+Adding and removing objects is saved up until the pairs are next needed,
+then done all at once: removed endpoints are taken out of each axis in one
+pass, and added ones are sorted and merged in, so a whole island of objects
+going to sleep costs about the same as one
+*/
+
+#include "darray.h"
+#include "hashmap.h"
+#include "octcube.h"
+
+// a pair of objects whose boxes overlap
+template <class T>
+struct SAPPair
+{
+	T a;
+	T b;
+};
+
+// one end of a box along an axis
+struct SAPEndpoint
+{
+	float value;
+	int proxy;
+	bool isMax;
+};
+
+// an object that's been put into the sweep and prune
+template <class T>
+struct SAPProxy
+{
+	T data;
+	// the object's actual box, and the fat one that's sorted
+	OctCube volume;
+	OctCube fat;
+
+	// where this proxy's endpoints are in each axis' list
+	int minIndex[3];
+	int maxIndex[3];
+
+	// waiting to be merged into or taken out of the endpoint lists
+	bool adding;
+	bool removing;
+};
+
+template <class T>
+class SweepAndPrune
+{
+public:
+	/***
+	 * @param margin How much bigger than the objects their fat boxes are
+	 */
+	SweepAndPrune(float margin = 0.1f)
+		: m_margin(margin), m_count(0), m_maxWidth(0.0f) {}
+
+	/***
+	 * @brief Puts an object into the sweep and prune
+	 *			It isn't sorted in until the next time the pairs are needed
+	 *
+	 * @param object Object to add
+	 * @param vol Bounding box of the object
+	 * @return Handle used to update or remove the object later
+	 */
+	int add(T object, OctCube const& vol)
+	{
+		// reuse a slot if there's one free, proxies are never deleted so
+		// adding doesn't allocate once there's been this many
+		int handle;
+		if (m_free.getCount() > 0)
+		{
+			handle = m_free[m_free.getCount() - 1];
+			m_free.pop();
+		}
+		else
+		{
+			handle = m_proxies.getCount();
+			m_proxies.add(SAPProxy<T>());
+		}
+
+		SAPProxy<T>& proxy = m_proxies[handle];
+		proxy.data = object;
+		proxy.volume = vol;
+		proxy.fat = fatten(vol);
+		proxy.adding = true;
+		proxy.removing = false;
+		growWidth(proxy.fat);
+
+		m_added.add(handle);
+		m_count++;
+		return handle;
+	}
+
+	/***
+	 * @brief Takes an object out of the sweep and prune
+	 *			It stops being given in pairs straight away, but its handle
+	 *			isn't reused until the next time the pairs are needed
+	 *
+	 * @param handle Handle given when the object was added
+	 */
+	void remove(int handle)
+	{
+		m_proxies[handle].removing = true;
+		m_removed.add(handle);
+		m_count--;
+	}
+
+	/***
+	 * @brief Moves an object's box, re-sorting its endpoints from where they
+	 *			were last time if it's left its fat box
+	 *
+	 * @param handle Handle given when the object was added
+	 * @param vol New bounding box of the object
+	 */
+	void update(int handle, OctCube const& vol)
+	{
+		SAPProxy<T>& proxy = m_proxies[handle];
+		if (proxy.removing)
+			return;
+
+		proxy.volume = vol;
+		if (contains(proxy.fat, vol))
+			return;
+
+		proxy.fat = fatten(vol);
+		growWidth(proxy.fat);
+
+		// it'll be sorted in wherever it is when it's merged
+		if (proxy.adding)
+			return;
+
+		for (int axis = 0; axis < 3; ++axis)
+		{
+			m_endpoints[axis][proxy.minIndex[axis]].value =
+				getMin(proxy.fat, axis);
+			m_endpoints[axis][proxy.maxIndex[axis]].value =
+				getMax(proxy.fat, axis);
+
+			// this order means the min never has to pass its own max
+			// (indices are read again each time, sorting moves them)
+			sortMinDown(axis, proxy.minIndex[axis]);
+			sortMaxUp(axis, proxy.maxIndex[axis]);
+			sortMinUp(axis, proxy.minIndex[axis]);
+			sortMaxDown(axis, proxy.maxIndex[axis]);
+		}
+	}
+
+	/***
+	 * @brief Gets every pair of objects whose boxes overlap, each pair is
+	 *			only given once
+	 *
+	 * @param pairs Array the pairs are added onto
+	 */
+	void getPairs(DArray<SAPPair<T>>& pairs)
+	{
+		flush();
+
+		// the fat boxes overlapping doesn't mean the objects do
+		m_overlaps.forEach([this, &pairs](unsigned long long key, bool)
+		{
+			SAPProxy<T>& a = m_proxies[(int)(key >> 32)];
+			SAPProxy<T>& b = m_proxies[(int)(key & 0xffffffff)];
+			if (cubesIntersect(a.volume, b.volume))
+				pairs.add({ a.data, b.data });
+		});
+	}
+
+	/***
+	 * @brief Gets every object whose box intersects a range
+	 *
+	 * @param range Box to check for intersection
+	 * @param list Array the objects are added onto
+	 */
+	void query(OctCube const& range, DArray<T>& list)
+	{
+		flush();
+
+		// nothing can start further back than the widest box before the
+		// range and still reach it, so skip straight there and walk along
+		// the x axis until we're past the end
+		DArray<SAPEndpoint>& xAxis = m_endpoints[0];
+		for (int i = findFirst(range.minX - m_maxWidth);
+			i < xAxis.getCount(); ++i)
+		{
+			SAPEndpoint& point = xAxis[i];
+			if (point.value > range.maxX)
+				break;
+			if (point.isMax)
+				continue;
+
+			SAPProxy<T>& proxy = m_proxies[point.proxy];
+			if (cubesIntersect(proxy.volume, range))
+				list.add(proxy.data);
+		}
+	}
+
+	/***
+	 * @brief Removes everything from the sweep and prune
+	 */
+	void clear()
+	{
+		m_proxies.clear();
+		m_free.clear();
+		m_added.clear();
+		m_removed.clear();
+
+		for (int axis = 0; axis < 3; ++axis)
+			m_endpoints[axis].clear();
+		m_overlaps.clear();
+
+		m_count = 0;
+		m_maxWidth = 0.0f;
+	}
+
+	int getCount() { return m_count; }
+
+	T getObject(int handle) { return m_proxies[handle].data; }
+
+private:
+	// every proxy there's been, including free ones
+	DArray<SAPProxy<T>> m_proxies;
+	// slots in m_proxies that can be reused
+	DArray<int> m_free;
+	// proxies waiting to be merged into or taken out of the lists
+	DArray<int> m_added;
+	DArray<int> m_removed;
+
+	// sorted endpoints along x, y and z
+	DArray<SAPEndpoint> m_endpoints[3];
+	// pairs whose fat boxes overlap, keyed by both handles, lower first
+	// (only the keys matter)
+	HashMap<bool> m_overlaps;
+
+	// endpoints being merged in, and pairs being checked for removal
+	DArray<SAPEndpoint> m_newPoints;
+	DArray<unsigned long long> m_keys;
+
+	float m_margin;
+	int m_count;
+	// widest any fat box has been along x since it was cleared, for knowing
+	// how far back a query has to start
+	float m_maxWidth;
+
+	static float getMin(OctCube const& vol, int axis)
+	{
+		return axis == 0 ? vol.minX : (axis == 1 ? vol.minY : vol.minZ);
+	}
+
+	static float getMax(OctCube const& vol, int axis)
+	{
+		return axis == 0 ? vol.maxX : (axis == 1 ? vol.maxY : vol.maxZ);
+	}
+
+	// sort order of endpoints, mins come before maxes with the same value
+	// so boxes that are just touching still count as overlapping
+	static bool isBefore(SAPEndpoint a, SAPEndpoint b)
+	{
+		return a.value < b.value ||
+			(a.value == b.value && !a.isMax && b.isMax);
+	}
+
+	OctCube fatten(OctCube const& vol)
+	{
+		return { vol.minX - m_margin, vol.minY - m_margin,
+			vol.minZ - m_margin, vol.maxX + m_margin, vol.maxY + m_margin,
+			vol.maxZ + m_margin };
+	}
+
+	static bool contains(OctCube const& outer, OctCube const& inner)
+	{
+		return inner.minX >= outer.minX && inner.minY >= outer.minY &&
+			inner.minZ >= outer.minZ && inner.maxX <= outer.maxX &&
+			inner.maxY <= outer.maxY && inner.maxZ <= outer.maxZ;
+	}
+
+	static unsigned long long pairKey(int a, int b)
+	{
+		int low = a < b ? a : b;
+		int high = a < b ? b : a;
+		return ((unsigned long long)low << 32) | (unsigned int)high;
+	}
+
+	void growWidth(OctCube const& vol)
+	{
+		if (vol.maxX - vol.minX > m_maxWidth)
+			m_maxWidth = vol.maxX - vol.minX;
+	}
+
+	/***
+	 * @brief Finds the first endpoint along the x axis that isn't below a
+	 *			value
+	 *
+	 * @param value Value to look for
+	 * @return Index of the endpoint, or the number of endpoints if they're
+	 *			all below it
+	 */
+	int findFirst(float value)
+	{
+		DArray<SAPEndpoint>& xAxis = m_endpoints[0];
+		int low = 0;
+		int high = xAxis.getCount();
+		while (low < high)
+		{
+			int mid = (low + high) / 2;
+			if (xAxis[mid].value < value)
+				low = mid + 1;
+			else
+				high = mid;
+		}
+		return low;
+	}
+
+	/***
+	 * @brief Takes out everything that's been removed and merges in
+	 *			everything that's been added since last time
+	 */
+	void flush()
+	{
+		if (m_removed.getCount() > 0)
+			flushRemoved();
+		if (m_added.getCount() > 0)
+			flushAdded();
+	}
+
+	void flushRemoved()
+	{
+		// squash the endpoints that are staying down over the removed ones
+		for (int axis = 0; axis < 3; ++axis)
+		{
+			DArray<SAPEndpoint>& list = m_endpoints[axis];
+			int kept = 0;
+			for (int i = 0; i < list.getCount(); ++i)
+			{
+				if (m_proxies[list[i].proxy].removing)
+					continue;
+				list[kept] = list[i];
+				setIndex(axis, kept++);
+			}
+			while (list.getCount() > kept)
+				list.pop();
+		}
+
+		// and any pairs they were in
+		m_keys.clear();
+		m_overlaps.getKeys(m_keys);
+		for (int i = 0; i < m_keys.getCount(); ++i)
+		{
+			unsigned long long key = m_keys[i];
+			if (m_proxies[(int)(key >> 32)].removing ||
+				m_proxies[(int)(key & 0xffffffff)].removing)
+				m_overlaps.remove(key);
+		}
+
+		for (int i = 0; i < m_removed.getCount(); ++i)
+		{
+			// never made it into the lists
+			SAPProxy<T>& proxy = m_proxies[m_removed[i]];
+			if (proxy.adding)
+			{
+				proxy.adding = false;
+				m_added.remove(m_removed[i]);
+			}
+
+			proxy.removing = false;
+			m_free.add(m_removed[i]);
+		}
+		m_removed.clear();
+	}
+
+	void flushAdded()
+	{
+		for (int axis = 0; axis < 3; ++axis)
+		{
+			// sort the new endpoints on their own
+			m_newPoints.clear();
+			for (int i = 0; i < m_added.getCount(); ++i)
+			{
+				int handle = m_added[i];
+				OctCube& vol = m_proxies[handle].fat;
+				m_newPoints.add({ getMin(vol, axis), handle, false });
+				m_newPoints.add({ getMax(vol, axis), handle, true });
+			}
+			m_newPoints.heapSort(isBefore);
+
+			// then merge them in from the back, so nothing has to be moved
+			// more than once
+			DArray<SAPEndpoint>& list = m_endpoints[axis];
+			int oldIndex = list.getCount() - 1;
+			for (int i = 0; i < m_newPoints.getCount(); ++i)
+				list.add(m_newPoints[i]);
+
+			int write = list.getCount() - 1;
+			for (int i = m_newPoints.getCount() - 1; i >= 0; --i)
+			{
+				while (oldIndex >= 0 && isBefore(m_newPoints[i], list[oldIndex]))
+					list[write--] = list[oldIndex--];
+				list[write--] = m_newPoints[i];
+			}
+
+			// everything above the last old endpoint that didn't move has
+			for (int i = oldIndex + 1; i < list.getCount(); ++i)
+				setIndex(axis, i);
+		}
+
+		for (int i = 0; i < m_added.getCount(); ++i)
+			m_proxies[m_added[i]].adding = false;
+
+		// everything's sorted now, so look for what each new box overlaps
+		// the same way a query does
+		DArray<SAPEndpoint>& xAxis = m_endpoints[0];
+		for (int i = 0; i < m_added.getCount(); ++i)
+		{
+			int handle = m_added[i];
+			OctCube& vol = m_proxies[handle].fat;
+
+			for (int j = findFirst(vol.minX - m_maxWidth);
+				j < xAxis.getCount(); ++j)
+			{
+				SAPEndpoint& point = xAxis[j];
+				if (point.value > vol.maxX)
+					break;
+				if (!point.isMax)
+					addOverlap(handle, point.proxy);
+			}
+		}
+		m_added.clear();
+	}
+
+	/***
+	 * @brief Swaps two neighbouring endpoints and fixes up the indices their
+	 *			proxies have of them
+	 */
+	void swapEndpoints(int axis, int i, int j)
+	{
+		DArray<SAPEndpoint>& list = m_endpoints[axis];
+		SAPEndpoint temp = list[i];
+		list[i] = list[j];
+		list[j] = temp;
+
+		setIndex(axis, i);
+		setIndex(axis, j);
+	}
+
+	void setIndex(int axis, int index)
+	{
+		SAPEndpoint& point = m_endpoints[axis][index];
+		SAPProxy<T>& proxy = m_proxies[point.proxy];
+		if (point.isMax)
+			proxy.maxIndex[axis] = index;
+		else
+			proxy.minIndex[axis] = index;
+	}
+
+	// a min moving down past a max means those two might start overlapping
+	void sortMinDown(int axis, int index)
+	{
+		DArray<SAPEndpoint>& list = m_endpoints[axis];
+		while (index > 0 && isBefore(list[index], list[index - 1]))
+		{
+			SAPEndpoint& prev = list[index - 1];
+			if (prev.isMax)
+				addOverlap(list[index].proxy, prev.proxy);
+			swapEndpoints(axis, index, index - 1);
+			index--;
+		}
+	}
+
+	// a min moving up past a max means those two might stop overlapping
+	void sortMinUp(int axis, int index)
+	{
+		DArray<SAPEndpoint>& list = m_endpoints[axis];
+		while (index < list.getCount() - 1 &&
+			isBefore(list[index + 1], list[index]))
+		{
+			SAPEndpoint& next = list[index + 1];
+			if (next.isMax)
+				removeOverlap(list[index].proxy, next.proxy);
+			swapEndpoints(axis, index, index + 1);
+			index++;
+		}
+	}
+
+	// a max moving up past a min means those two might start overlapping
+	void sortMaxUp(int axis, int index)
+	{
+		DArray<SAPEndpoint>& list = m_endpoints[axis];
+		while (index < list.getCount() - 1 &&
+			isBefore(list[index + 1], list[index]))
+		{
+			SAPEndpoint& next = list[index + 1];
+			if (!next.isMax)
+				addOverlap(list[index].proxy, next.proxy);
+			swapEndpoints(axis, index, index + 1);
+			index++;
+		}
+	}
+
+	// a max moving down past a min means those two might stop overlapping
+	void sortMaxDown(int axis, int index)
+	{
+		DArray<SAPEndpoint>& list = m_endpoints[axis];
+		while (index > 0 && isBefore(list[index], list[index - 1]))
+		{
+			SAPEndpoint& prev = list[index - 1];
+			if (!prev.isMax)
+				removeOverlap(list[index].proxy, prev.proxy);
+			swapEndpoints(axis, index, index - 1);
+			index--;
+		}
+	}
+
+	// only one axis has changed when this is called, so the whole boxes
+	// need checking before the pair actually counts
+	// adding one that's already there just finds it again
+	void addOverlap(int a, int b)
+	{
+		if (a == b)
+			return;
+		SAPProxy<T>& proxyA = m_proxies[a];
+		SAPProxy<T>& proxyB = m_proxies[b];
+		// removed ones are still in the lists until they're flushed
+		if (proxyA.removing || proxyB.removing)
+			return;
+		if (!cubesIntersect(proxyA.fat, proxyB.fat))
+			return;
+
+		m_overlaps[pairKey(a, b)] = true;
+	}
+
+	void removeOverlap(int a, int b)
+	{
+		if (a == b)
+			return;
+		if (cubesIntersect(m_proxies[a].fat, m_proxies[b].fat))
+			return;
+
+		m_overlaps.remove(pairKey(a, b));
+	}
+};
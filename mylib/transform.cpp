@@ -0,0 +1,44 @@
+#include "transform.h"
+
+#include "matrix4.h"
+
+Transform::Transform() { }
+
+Transform::Transform(Vector3 const& position, Quaternion const& rotation)
+	: position(position), rotation(rotation) { }
+
+Vector3 Transform::transformPoint(Vector3 const& p) const
+{
+	Vector3 result = rotation.rotate(p);
+	result += position;
+	return result;
+}
+
+Vector3 Transform::inverseTransformPoint(Vector3 const& p) const
+{
+	Vector3 local = p;
+	local -= position;
+	return rotation.inverseRotate(local);
+}
+
+Transform Transform::inverse() const
+{
+	// undo the rotation, then undo the position in the undone rotation
+	Quaternion undone = rotation.inverse();
+	Vector3 back = undone.rotate(position);
+	back *= -1.0f;
+	return Transform(back, undone);
+}
+
+Matrix4 Transform::toMatrix() const
+{
+	Matrix4 m = rotation.toMatrix();
+	m.setPosition(position);
+	return m;
+}
+
+Transform Transform::operator*(Transform const& other) const
+{
+	return Transform(transformPoint(other.position),
+		rotation * other.rotation);
+}
@@ -0,0 +1,72 @@
+#pragma once
+/*
+Transform - Position and rotation, without scale
+Everything a rigid body needs to be put somewhere, in 7 floats instead of
+a Matrix4's 16, and it can be undone without working out a whole inverse
+matrix. toMatrix() makes a Matrix4 for things like rendering that need one
+*/
+
+#ifdef MYLIB_DYNAMIC
+	#ifdef MYLIB_EXPORT
+		#define MYLIB_SPEC __declspec(dllexport)
+	#else
+		#define MYLIB_SPEC __declspec(dllimport)
+	#endif
+#else
+	#define MYLIB_SPEC
+#endif
+
+#include "quaternion.h"
+#include "vector3.h"
+
+struct Matrix4;
+
+struct Transform
+{
+	/***
+	 * @brief Makes a transform that doesn't move or rotate anything
+	 */
+	MYLIB_SPEC Transform();
+	MYLIB_SPEC Transform(Vector3 const& position, Quaternion const& rotation);
+
+	/***
+	 * @brief Rotates and then moves a point
+	 *
+	 * @param p Point to transform
+	 * @return The transformed point
+	 */
+	MYLIB_SPEC Vector3 transformPoint(Vector3 const& p) const;
+	/***
+	 * @brief Takes a transformed point back to where it started
+	 *
+	 * @param p Point to take back
+	 * @return The point before it was transformed
+	 */
+	MYLIB_SPEC Vector3 inverseTransformPoint(Vector3 const& p) const;
+
+	/***
+	 * @brief Gets the transform that undoes this one
+	 *
+	 * @return The inverse transform
+	 */
+	MYLIB_SPEC Transform inverse() const;
+
+	/***
+	 * @brief Makes a matrix that does the same thing as this transform
+	 *
+	 * @return The matrix
+	 */
+	MYLIB_SPEC Matrix4 toMatrix() const;
+
+	/***
+	 * @brief Combines two transforms, the result does other and then this
+	 *			(the same order as multiplying matrices)
+	 *
+	 * @param other Transform to do first
+	 * @return The combined transform
+	 */
+	MYLIB_SPEC Transform operator*(Transform const& other) const;
+
+	Vector3 position;
+	Quaternion rotation;
+};
@@ -19,13 +19,6 @@ Vector3::Vector3(int x, int y, int z)
 	this->z = (float)z;
 }
 
-Vector3::Vector3(const Vector3& vec)
-{
-	x = vec.x;
-	y = vec.y;
-	z = vec.z;
-}
-
 float Vector3::dot(Vector3 const& vec) const
 {
 	return Vector3::dot(*this, vec);
@@ -215,14 +208,6 @@ Vector3& Vector3::operator*=(Vector3 const& vec)
 	return *this;
 }
 
-Vector3& Vector3::operator=(Vector3 const& vec)
-{
-	x = vec.x;
-	y = vec.y;
-	z = vec.z;
-	return *this;
-}
-
 Vector3& Vector3::operator+=(Vector3 const& vec)
 {
 	x += vec.x;
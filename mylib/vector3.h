@@ -23,8 +23,9 @@ struct Vector3
 	MYLIB_SPEC Vector3(int x, int y, int z);
 	MYLIB_SPEC ~Vector3() = default;
 
-	// copy constructor
-	MYLIB_SPEC Vector3(const Vector3& vec);
+	// copying is just copying the 3 floats, so the compiler can do it (and
+	// it's allowed to memcpy them around)
+	MYLIB_SPEC Vector3(const Vector3& vec) = default;
 
 	// move constructors aren't needed (I think)
 	MYLIB_SPEC Vector3(Vector3&& vec) = default;
@@ -227,7 +228,7 @@ struct Vector3
 	 * @param vec Vector to copy values from
 	 * @return A reference to this vector which was changed
 	 */
-	MYLIB_SPEC Vector3& operator= (Vector3 const& vec);
+	MYLIB_SPEC Vector3& operator= (Vector3 const& vec) = default;
 	/***
 	 * @brief Checks if this vector is approximately equal to another one
 	 * 
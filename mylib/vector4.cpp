@@ -12,14 +12,6 @@ Vector4::Vector4()
 Vector4::Vector4(float x, float y, float z, float w)
 	: x(x), y(y), z(z), w(w) { }
 
-Vector4::Vector4(const Vector4& vec)
-{
-	x = vec.x;
-	y = vec.y;
-	z = vec.z;
-	w = vec.w;
-}
-
 float Vector4::dot(Vector4 const& vec) const
 {
 	return Vector4::dot(*this, vec);
@@ -171,82 +163,70 @@ void Vector4::clamp(Vector4 const& min, Vector4 const& max)
 		w = max.w;
 }
 
+// all the values are next to each other, so they can all be
+// done at once
 Vector4 Vector4::operator+(Vector4 const& vec)
 {
-	return {x + vec.x, y + vec.y, z + vec.z, w + vec.w };
+	Vector4 result;
+	float4StoreU(&result.x, float4Add(float4LoadU(&x), float4LoadU(&vec.x)));
+	return result;
 }
 
 Vector4 Vector4::operator-(Vector4 const& vec)
 {
-	return {x - vec.x, y - vec.y, z - vec.z, w - vec.w };
+	Vector4 result;
+	float4StoreU(&result.x, float4Sub(float4LoadU(&x), float4LoadU(&vec.x)));
+	return result;
 }
 
 Vector4 Vector4::operator*(float mul)
 {
-	return {x * mul, y * mul, z * mul, w * mul };
+	Vector4 result;
+	float4StoreU(&result.x, float4Mul(float4LoadU(&x), float4Splat(mul)));
+	return result;
 }
 
 Vector4& Vector4::operator*=(float mul)
 {
-	x *= mul;
-	y *= mul;
-	z *= mul;
-	w *= mul;
+	float4StoreU(&x, float4Mul(float4LoadU(&x), float4Splat(mul)));
 	return *this;
 }
 
 Vector4 Vector4::operator/(float div)
 {
-	return { x / div, y / div, z / div, w / div };
+	Vector4 result;
+	float4StoreU(&result.x, float4Div(float4LoadU(&x), float4Splat(div)));
+	return result;
 }
 
 Vector4& Vector4::operator/=(float div)
 {
-	x /= div;
-	y /= div;
-	z /= div;
-	w /= div;
+	float4StoreU(&x, float4Div(float4LoadU(&x), float4Splat(div)));
 	return *this;
 }
 
 Vector4 Vector4::operator*(Vector4 const& vec)
 {
-	return { x * vec.x, y * vec.y, z * vec.z, w * vec.w };
+	Vector4 result;
+	float4StoreU(&result.x, float4Mul(float4LoadU(&x), float4LoadU(&vec.x)));
+	return result;
 }
 
 Vector4& Vector4::operator*=(Vector4 const& vec)
 {
-	x *= vec.x;
-	y *= vec.y;
-	z *= vec.z;
-	w *= vec.w;
-	return *this;
-}
-
-Vector4& Vector4::operator=(Vector4 const& vec)
-{
-	x = vec.x;
-	y = vec.y;
-	z = vec.z;
-	w = vec.w;
+	float4StoreU(&x, float4Mul(float4LoadU(&x), float4LoadU(&vec.x)));
 	return *this;
 }
 
 Vector4& Vector4::operator+=(Vector4 const& vec)
 {
-	x += vec.x;
-	y += vec.y;
-	z += vec.z;
-	w += vec.w;
+	float4StoreU(&x, float4Add(float4LoadU(&x), float4LoadU(&vec.x)));
 	return *this;
 }
 
 Vector4& Vector4::operator-=(Vector4 const& vec)
 {
-	x -= vec.x;
-	y -= vec.y;
-	z -= vec.z;
-	w -= vec.w;
+	float4StoreU(&x, float4Sub(float4LoadU(&x), float4LoadU(&vec.x)));
 	return *this;
 }
 
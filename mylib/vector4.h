@@ -1,6 +1,7 @@
 #pragma once
 
 #include "vector3.h"
+#include "simd.h"
 
 #ifdef MYLIB_DYNAMIC
 	#ifdef MYLIB_EXPORT
@@ -12,6 +13,9 @@
 	#define MYLIB_SPEC 
 #endif
 
+// not aligned on purpose - C++14 new doesn't honour alignas, so heap copies
+// (World, Camera, DArray<Vector4>...) would break aligned loads. the SSE
+// paths use unaligned loads instead
 struct Vector4
 {
 	/***
@@ -24,8 +28,8 @@ struct Vector4
 	MYLIB_SPEC Vector4(float x, float y, float z, float w);
 	MYLIB_SPEC ~Vector4() = default;
 
-	// copy constructor
-	MYLIB_SPEC Vector4(const Vector4& vec);
+	// copying is just copying the 4 floats, so the compiler can do it
+	MYLIB_SPEC Vector4(const Vector4& vec) = default;
 
 	// I don't even know about move constructors
 	MYLIB_SPEC Vector4(Vector4&& vec) = default;
@@ -230,7 +234,7 @@ struct Vector4
 	 * @param vec Vector to copy values from
 	 * @return A reference to this vector which was changed
 	 */
-	MYLIB_SPEC Vector4& operator= (Vector4 const& vec);
+	MYLIB_SPEC Vector4& operator= (Vector4 const& vec) = default;
 	/***
 	 * @brief Checks if this vector is approximately equal to another one
 	 * 
@@ -271,9 +275,10 @@ struct Vector4
 };
 
 // operator for float * Vector4
-static Vector4 operator*(float lhs, Vector4 rhs)
+static Vector4 operator*(float lhs, Vector4 const& rhs)
 {
-	return rhs * lhs;
+	Vector4 result = rhs;
+	return result * lhs;
 }
 
 // multi-line inline
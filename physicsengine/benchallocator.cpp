@@ -0,0 +1,53 @@
+/* =================================
+ *  Bench Allocator
+ *  Replaces the global new and delete for the physics bench, counting every
+ *  heap allocation
+ * ================================= */
+#include "benchallocator.h"
+
+#include <atomic>
+#include <cstdlib>
+#include <new>
+
+static std::atomic<long long> s_allocations(0);
+
+long long getAllocationCount()
+{
+	return s_allocations;
+}
+
+void* operator new(size_t size)
+{
+	s_allocations++;
+	void* memory = malloc(size > 0 ? size : 1);
+	if (!memory)
+		throw std::bad_alloc();
+	return memory;
+}
+
+void* operator new[](size_t size)
+{
+	return operator new(size);
+}
+
+// every way of deleting has to be replaced too, or the library's could end
+// up being given memory from our new
+void operator delete(void* memory) noexcept
+{
+	free(memory);
+}
+
+void operator delete(void* memory, size_t) noexcept
+{
+	free(memory);
+}
+
+void operator delete[](void* memory) noexcept
+{
+	free(memory);
+}
+
+void operator delete[](void* memory, size_t) noexcept
+{
+	free(memory);
+}
@@ -0,0 +1,14 @@
+/* =================================
+ *  Bench Allocator
+ *  Replaces the global new and delete for the physics bench, counting every
+ *  heap allocation so parts of a step that shouldn't be allocating can be
+ *  checked
+ *
+ *  They're in their own file so the compiler can't inline them into the
+ *  bench, where it would see our free() being called on memory from what
+ *  it thinks is the library's new
+ * ================================= */
+#pragma once
+
+// number of heap allocations made so far, by anything on any thread
+long long getAllocationCount();
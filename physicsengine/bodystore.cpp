@@ -0,0 +1,262 @@
+/* =================================
+ *  BodyStore
+ *  Keeps the data of every PhysicsBody that's touched each step in flat
+ *  arrays (one per value)
+ * ================================= */
+#include "bodystore.h"
+
+#include "physicsbody.h"
+
+// use SSE to integrate 4 bodies at once when the compiler has it
+#if defined(__SSE2__) || defined(_M_X64) || \
+	(defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+	#define BODYSTORE_SSE
+	#include <emmintrin.h>
+#endif
+
+int BodyStore::add(PhysicsBody* body)
+{
+	// reuse a slot if there's one free
+	int index;
+	if (m_free.getCount() > 0)
+	{
+		index = m_free[m_free.getCount() - 1];
+		m_free.pop();
+	}
+	else
+	{
+		index = flags.getCount();
+
+		posX.add(0); posY.add(0); posZ.add(0);
+		velX.add(0); velY.add(0); velZ.add(0);
+		angX.add(0); angY.add(0); angZ.add(0);
+		mass.add(0);
+		invMass.add(0);
+		drag.add(0);
+		angularDrag.add(0);
+		gravityScale.add(0);
+		flags.add(0);
+		orientations.add(Quaternion());
+		prevX.add(0); prevY.add(0); prevZ.add(0);
+		prevOrientations.add(Quaternion());
+		bodies.add(nullptr);
+		m_moving.add(0);
+	}
+
+	// default values
+	posX[index] = 0.0f; posY[index] = 0.0f; posZ[index] = 0.0f;
+	velX[index] = 0.0f; velY[index] = 0.0f; velZ[index] = 0.0f;
+	angX[index] = 0.0f; angY[index] = 0.0f; angZ[index] = 0.0f;
+	mass[index] = 1.0f;
+	invMass[index] = 1.0f;
+	drag[index] = 0.0f;
+	angularDrag[index] = 1.0f;
+	gravityScale[index] = 1.0f;
+	flags[index] = BODY_USED | BODY_ENABLED;
+	orientations[index] = Quaternion();
+	prevX[index] = 0.0f; prevY[index] = 0.0f; prevZ[index] = 0.0f;
+	prevOrientations[index] = Quaternion();
+	bodies[index] = body;
+	m_moving[index] = 0.0f;
+
+	return index;
+}
+
+void BodyStore::remove(int index)
+{
+	// clearing the flags stops the integrator touching this slot
+	flags[index] = 0;
+	bodies[index] = nullptr;
+	m_free.add(index);
+}
+
+void BodyStore::integrate(int start, int end, float delta, float gravity)
+{
+	// figure out which bodies move up front so the loop doesn't need to
+	// look at flags at all
+	for (int i = start; i < end; ++i)
+	{
+		// everything remembers where it was, even bodies that don't move
+		// since they could have been moved since last step
+		prevX[i] = posX[i];
+		prevY[i] = posY[i];
+		prevZ[i] = posZ[i];
+		prevOrientations[i] = orientations[i];
+
+		int f = flags[i];
+		bool moving = (f & BODY_MOVING_FLAGS) == BODY_MOVING_FLAGS &&
+			(f & BODY_STILL_FLAGS) == 0;
+		m_moving[i] = moving ? 1.0f : 0.0f;
+
+		// a body that isn't going anywhere keeps its points where they are
+		if (moving && (velX[i] != 0.0f || velY[i] != 0.0f ||
+			velZ[i] != 0.0f || angX[i] != 0.0f || angY[i] != 0.0f ||
+			angZ[i] != 0.0f || gravityScale[i] != 0.0f))
+			flags[i] |= BODY_SHAPE_DIRTY;
+	}
+
+	integrateLinear(start, end, delta, gravity);
+
+	// rotation needs a square root and some trig so it isn't done in the
+	// loop above, but only bodies that are actually spinning need it
+	for (int i = start; i < end; ++i)
+	{
+		if (m_moving[i] == 0.0f)
+			continue;
+		if (angX[i] == 0.0f && angY[i] == 0.0f && angZ[i] == 0.0f)
+			continue;
+
+		orientations[i].integrate(Vector3(angX[i], angY[i], angZ[i]), delta);
+		flags[i] |= BODY_ROTATED;
+	}
+}
+
+void BodyStore::integrateLinear(int start, int end, float delta,
+	float gravity)
+{
+#ifdef BODYSTORE_SSE
+	// DArray doesn't like giving out its array, but SSE needs it
+	float* px = posX._getArray();
+	float* py = posY._getArray();
+	float* pz = posZ._getArray();
+	float* vx = velX._getArray();
+	float* vy = velY._getArray();
+	float* vz = velZ._getArray();
+	float* ax = angX._getArray();
+	float* ay = angY._getArray();
+	float* az = angZ._getArray();
+	float* dragArr = drag._getArray();
+	float* angDragArr = angularDrag._getArray();
+	float* gravArr = gravityScale._getArray();
+	float* movingArr = m_moving._getArray();
+
+	const __m128 d = _mm_set1_ps(delta);
+	const __m128 g = _mm_set1_ps(gravity);
+	const __m128 one = _mm_set1_ps(1.0f);
+	const __m128 linThreshold =
+		_mm_set1_ps(MIN_LINEAR_THRESHOLD*MIN_LINEAR_THRESHOLD);
+	const __m128 rotThreshold =
+		_mm_set1_ps(MIN_ROTATIONAL_THRESHOLD*MIN_ROTATIONAL_THRESHOLD);
+
+	// this does exactly the same maths in the same order as the scalar
+	// version, so both give the same results
+	int i = start;
+	for (; i + 4 <= end; i += 4)
+	{
+		__m128 moving = _mm_loadu_ps(movingArr + i);
+		__m128 isMoving = _mm_cmpeq_ps(moving, one);
+
+		__m128 x = _mm_loadu_ps(vx + i);
+		__m128 y = _mm_loadu_ps(vy + i);
+		__m128 z = _mm_loadu_ps(vz + i);
+
+		// apply gravity
+		__m128 grav = _mm_mul_ps(_mm_mul_ps(_mm_loadu_ps(gravArr + i), g), d);
+		y = _mm_sub_ps(y, _mm_mul_ps(grav, moving));
+
+		// drags
+		__m128 dr = _mm_loadu_ps(dragArr + i);
+		x = _mm_sub_ps(x, _mm_mul_ps(_mm_mul_ps(_mm_mul_ps(x, dr), d), moving));
+		y = _mm_sub_ps(y, _mm_mul_ps(_mm_mul_ps(_mm_mul_ps(y, dr), d), moving));
+		z = _mm_sub_ps(z, _mm_mul_ps(_mm_mul_ps(_mm_mul_ps(z, dr), d), moving));
+
+		__m128 rx = _mm_loadu_ps(ax + i);
+		__m128 ry = _mm_loadu_ps(ay + i);
+		__m128 rz = _mm_loadu_ps(az + i);
+		__m128 adr = _mm_loadu_ps(angDragArr + i);
+		rx = _mm_sub_ps(rx,
+			_mm_mul_ps(_mm_mul_ps(_mm_mul_ps(rx, adr), d), moving));
+		ry = _mm_sub_ps(ry,
+			_mm_mul_ps(_mm_mul_ps(_mm_mul_ps(ry, adr), d), moving));
+		rz = _mm_sub_ps(rz,
+			_mm_mul_ps(_mm_mul_ps(_mm_mul_ps(rz, adr), d), moving));
+
+		// apply minimum velocity thresholds
+		__m128 mag = _mm_add_ps(_mm_add_ps(_mm_mul_ps(x, x), _mm_mul_ps(y, y)),
+			_mm_mul_ps(z, z));
+		__m128 stop = _mm_and_ps(_mm_cmplt_ps(mag, linThreshold), isMoving);
+		x = _mm_andnot_ps(stop, x);
+		y = _mm_andnot_ps(stop, y);
+		z = _mm_andnot_ps(stop, z);
+
+		mag = _mm_add_ps(_mm_add_ps(_mm_mul_ps(rx, rx), _mm_mul_ps(ry, ry)),
+			_mm_mul_ps(rz, rz));
+		stop = _mm_and_ps(_mm_cmplt_ps(mag, rotThreshold), isMoving);
+		rx = _mm_andnot_ps(stop, rx);
+		ry = _mm_andnot_ps(stop, ry);
+		rz = _mm_andnot_ps(stop, rz);
+
+		_mm_storeu_ps(vx + i, x);
+		_mm_storeu_ps(vy + i, y);
+		_mm_storeu_ps(vz + i, z);
+		_mm_storeu_ps(ax + i, rx);
+		_mm_storeu_ps(ay + i, ry);
+		_mm_storeu_ps(az + i, rz);
+
+		// apply velocities
+		_mm_storeu_ps(px + i, _mm_add_ps(_mm_loadu_ps(px + i),
+			_mm_mul_ps(_mm_mul_ps(x, d), moving)));
+		_mm_storeu_ps(py + i, _mm_add_ps(_mm_loadu_ps(py + i),
+			_mm_mul_ps(_mm_mul_ps(y, d), moving)));
+		_mm_storeu_ps(pz + i, _mm_add_ps(_mm_loadu_ps(pz + i),
+			_mm_mul_ps(_mm_mul_ps(z, d), moving)));
+	}
+
+	// whatever's left over that doesn't fill 4
+	integrateLinearScalar(i, end, delta, gravity);
+#else
+	integrateLinearScalar(start, end, delta, gravity);
+#endif
+}
+
+void BodyStore::integrateLinearScalar(int start, int end, float delta,
+	float gravity)
+{
+	for (int i = start; i < end; ++i)
+	{
+		// 1 or 0, multiplying by it leaves bodies that don't move alone
+		float moving = m_moving[i];
+
+		float x = velX[i];
+		float y = velY[i];
+		float z = velZ[i];
+
+		// apply gravity
+		y -= (gravityScale[i] * gravity * delta) * moving;
+
+		// drags
+		x -= ((x * drag[i]) * delta) * moving;
+		y -= ((y * drag[i]) * delta) * moving;
+		z -= ((z * drag[i]) * delta) * moving;
+
+		float rx = angX[i];
+		float ry = angY[i];
+		float rz = angZ[i];
+		rx -= ((rx * angularDrag[i]) * delta) * moving;
+		ry -= ((ry * angularDrag[i]) * delta) * moving;
+		rz -= ((rz * angularDrag[i]) * delta) * moving;
+
+		// apply minimum velocity thresholds
+		if (moving == 1.0f)
+		{
+			if ((x*x) + (y*y) + (z*z) <
+				MIN_LINEAR_THRESHOLD*MIN_LINEAR_THRESHOLD)
+				x = y = z = 0.0f;
+			if ((rx*rx) + (ry*ry) + (rz*rz) <
+				MIN_ROTATIONAL_THRESHOLD*MIN_ROTATIONAL_THRESHOLD)
+				rx = ry = rz = 0.0f;
+		}
+
+		velX[i] = x;
+		velY[i] = y;
+		velZ[i] = z;
+		angX[i] = rx;
+		angY[i] = ry;
+		angZ[i] = rz;
+
+		// apply velocities
+		posX[i] += (x * delta) * moving;
+		posY[i] += (y * delta) * moving;
+		posZ[i] += (z * delta) * moving;
+	}
+}
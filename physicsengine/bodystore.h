@@ -0,0 +1,125 @@
+/* =================================
+ *  BodyStore
+ *  Keeps the data of every PhysicsBody that's touched each step in flat
+ *  arrays (one per value), so the integrator can run over them in one
+ *  tight loop instead of jumping between bodies all over the heap
+ *
+ *  Bodies are just a slot in here, PhysicsBody looks its values up with
+ *  the index it was given when it was made
+ * ================================= */
+#pragma once
+
+#include <darray.h>
+#include <quaternion.h>
+
+class PhysicsBody;
+
+// flags kept for each body in the store
+enum BodyFlags
+{
+	// slot is being used by a body
+	BODY_USED = 1 << 0,
+	// body has been added to the PhysicsManager
+	BODY_IN_WORLD = 1 << 1,
+	BODY_ENABLED = 1 << 2,
+	BODY_STATIC = 1 << 3,
+	BODY_ZONE = 1 << 4,
+	BODY_ASLEEP = 1 << 5,
+	BODY_HAS_COLLIDER = 1 << 6,
+	// body rotated while being integrated, so its broad extents need
+	// updating
+	BODY_ROTATED = 1 << 7,
+	// body moved, rotated or changed shape since its points were last put
+	// into the world
+	BODY_SHAPE_DIRTY = 1 << 8,
+	// body gets swept through each step when it's moving fast, see CCD
+	BODY_CONTINUOUS = 1 << 9,
+	// body was moved or changed size since the broadphase last looked at it,
+	// which matters for resting bodies since they aren't updated otherwise
+	BODY_BROAD_MOVED = 1 << 10
+};
+
+// flags a body needs to have (and not have) to be moved by the integrator
+#define BODY_MOVING_FLAGS \
+	(BODY_USED | BODY_IN_WORLD | BODY_ENABLED | BODY_HAS_COLLIDER)
+#define BODY_STILL_FLAGS (BODY_STATIC | BODY_ASLEEP)
+
+class BodyStore
+{
+public:
+	/***
+	 * @brief Makes a slot for a body, filled with default values
+	 *
+	 * @param body Body the slot belongs to
+	 * @return Index of the slot
+	 */
+	int add(PhysicsBody* body);
+	/***
+	 * @brief Frees up a body's slot so it can be reused
+	 *
+	 * @param index Index of the slot
+	 */
+	void remove(int index);
+
+	// number of slots, including ones that aren't being used
+	int getCount() { return flags.getCount(); }
+
+	/***
+	 * @brief Applies gravity and drag to every moving body in a range of
+	 *			slots and moves it by its velocity
+	 *			Bodies that rotate are given the BODY_ROTATED flag, and every
+	 *			body that moves is given BODY_SHAPE_DIRTY
+	 *			Where every body was beforehand is kept as its previous
+	 *			position and orientation
+	 *			Slots don't affect each other, so ranges can be done on
+	 *			different threads at the same time
+	 *
+	 * @param start First slot to integrate
+	 * @param end Slot to stop at (not included)
+	 * @param delta Length of the step
+	 * @param gravity Strength of gravity
+	 */
+	void integrate(int start, int end, float delta, float gravity);
+
+	// positions
+	DArray<float> posX, posY, posZ;
+	// linear velocities
+	DArray<float> velX, velY, velZ;
+	// angular velocities
+	DArray<float> angX, angY, angZ;
+
+	DArray<float> mass;
+	// 0 for static bodies
+	DArray<float> invMass;
+	DArray<float> drag;
+	DArray<float> angularDrag;
+	// how much gravity affects the body, 0 when it doesn't use gravity
+	DArray<float> gravityScale;
+
+	// BodyFlags
+	DArray<int> flags;
+
+	// just the rotation part of the body's transform
+	DArray<Quaternion> orientations;
+
+	// where each body was before the last step, so it can be drawn part way
+	// between steps
+	DArray<float> prevX, prevY, prevZ;
+	DArray<Quaternion> prevOrientations;
+
+	// body each slot belongs to
+	DArray<PhysicsBody*> bodies;
+
+private:
+	// slots that can be reused
+	DArray<int> m_free;
+
+	// 1 for bodies the integrator should move and 0 for everything else,
+	// kept as floats so the integrator can multiply by it instead of branching
+	DArray<float> m_moving;
+
+	// runs the linear part of integration over a range of bodies
+	void integrateLinear(int start, int end, float delta, float gravity);
+	void integrateLinearScalar(int start, int end, float delta,
+		float gravity);
+};
@@ -54,7 +54,7 @@ Matrix4 Camera::getViewMatrix()
 	return transform.inverse();
 }
 
-void Camera::setParentMatrix(Matrix4 m)
+void Camera::setParentMatrix(Matrix4 const& m)
 {
 	m_parentMatrix = m;
 }
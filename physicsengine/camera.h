@@ -28,7 +28,7 @@ public:
 
 	// set the "parent" matrix - a transform matrix that the view matrix is
 	// transformed by
-	void setParentMatrix(Matrix4 m);
+	void setParentMatrix(Matrix4 const& m);
 	Matrix4 getParentMatrix() { return m_parentMatrix; }
 
 private:
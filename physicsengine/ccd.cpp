@@ -0,0 +1,169 @@
+/* =================================
+ *  CCD
+ *  Sweeps fast bodies through the step so they can't tunnel through
+ *  anything
+ * ================================= */
+#include "ccd.h"
+
+#include <cmath>
+
+#include "collider.h"
+#include "gjk.h"
+#include "physicsbody.h"
+
+// most times a sweep moves the body forward before giving up
+#define CCD_MAX_ITERATIONS 32
+// most things a body can hit and slide off in one step
+#define CCD_MAX_HITS 4
+// shapes this close together count as touching
+#define CCD_TOLERANCE 0.005f
+// how far a body that hit something is left inside it, so the narrowphase
+// finds the contact
+#define CCD_SKIN 0.01f
+
+bool CCD::isFast(PhysicsBody* body, float delta)
+{
+	Collider* col = body->getCollider();
+	if (!col)
+		return false;
+
+	// anything moving less than its own half width will still be overlapping
+	// whatever it moved into at the end of the step
+	Vector3 ext = col->boundsExtents;
+	float thinnest = fminf(ext.x, fminf(ext.y, ext.z));
+	float travel = body->getVelocity().magnitude() * delta;
+	return travel > thinnest;
+}
+
+bool CCD::sweep(PhysicsBody* body, DArray<PhysicsBody*>& others,
+	float delta)
+{
+	Vector3 motion = body->getVelocity();
+	motion *= delta;
+	// how much of the step the motion that's left takes up
+	float left = 1.0f;
+
+	bool hitAnything = false;
+	for (int hits = 0; hits < CCD_MAX_HITS; ++hits)
+	{
+		// find whatever it hits first
+		bool hit = false;
+		float first = 1.0f;
+		Vector3 firstNormal;
+		float firstDist = 0.0f;
+		for (int i = 0; i < others.getCount(); ++i)
+		{
+			PhysicsBody* other = others[i];
+			if (other == body || !other->isEnabled() ||
+				!other->getCollider() || other->isZone())
+				continue;
+
+			// sweep in the other body's space, as if it was standing still
+			Vector3 relative = motion;
+			if (!other->isStatic())
+			{
+				Vector3 otherMotion = other->getVelocity();
+				otherMotion *= delta * left;
+				relative -= otherMotion;
+			}
+
+			float time;
+			Vector3 normal;
+			float dist;
+			if (timeOfImpact(body, other, relative, time, normal, dist) &&
+				time < first)
+			{
+				hit = true;
+				first = time;
+				firstNormal = normal;
+				firstDist = dist;
+			}
+		}
+
+		if (!hit)
+			break;
+		hitAnything = true;
+
+		// take back the part of the rest of its own move that went into the
+		// other body, but keep anything sideways so it slides along it
+		// (the other body isn't moved back, it's the one being hit)
+		Vector3 rest = motion * (1.0f - first);
+		float into = rest.dot(firstNormal);
+		if (into < 0.0f)
+			into = 0.0f;
+
+		// and leave it just inside so it gets a contact like anything else
+		Vector3 pos = body->getPosition();
+		pos -= firstNormal * (into - firstDist - CCD_SKIN);
+		body->moveTo(pos);
+
+		// the slide could take it through something else, so that gets
+		// swept too (whatever it just hit won't be, it's already touching)
+		motion = rest - firstNormal * into;
+		left *= 1.0f - first;
+		if (motion.magnitudeSquared() < CCD_TOLERANCE * CCD_TOLERANCE)
+			break;
+	}
+	return hitAnything;
+}
+
+bool CCD::timeOfImpact(PhysicsBody* a, PhysicsBody* b,
+	Vector3 const& motion, float& timeOut, Vector3& normalOut,
+	float& distOut)
+{
+	Vector3 end = a->getPosition();
+	Vector3 start = end - motion;
+	Vector3 step = motion;
+
+	bool hit = false;
+	float time = 0.0f;
+	Vector3 normal;
+	float dist = 0.0f;
+	for (int i = 0; i < CCD_MAX_ITERATIONS; ++i)
+	{
+		a->moveTo(start + step * time);
+
+		Vector3 pointA;
+		Vector3 pointB;
+		if (!GJK::distance(a, b, dist, pointA, pointB) || dist < 1e-6f)
+		{
+			// overlapping right from the start is a normal contact, the
+			// narrowphase will deal with that
+			// later on it means it got all the way there
+			if (i > 0)
+			{
+				hit = true;
+				dist = 0.0f;
+			}
+			break;
+		}
+
+		normal = (pointB - pointA) / dist;
+
+		// as long as it only moves (and doesn't turn) the distance can't
+		// ever drop faster than it is now, so if it isn't getting closer
+		// it never will
+		float closing = step.dot(normal);
+		if (closing <= 0.0f)
+			break;
+
+		if (dist < CCD_TOLERANCE)
+		{
+			hit = true;
+			break;
+		}
+
+		// move as far as it can without possibly getting closer than half
+		// the tolerance
+		time += (dist - CCD_TOLERANCE * 0.5f) / closing;
+		if (time > 1.0f)
+			break;
+	}
+
+	a->moveTo(end);
+
+	timeOut = time;
+	normalOut = normal;
+	distOut = dist;
+	return hit;
+}
@@ -0,0 +1,71 @@
+/* =================================
+ *  CCD
+ *  Continuous collision detection, for bodies that move far enough in one
+ *  step to pass straight through something thin without ever being seen
+ *  overlapping it
+ *
+ *  Bodies that want it turn it on with PhysicsBody::setContinuous. When one
+ *  moves further than its own thickness in a step its broad box is
+ *  stretched back over the whole move, and after the broadphase the
+ *  PhysicsManager sweeps it from where it was to where it ended up against
+ *  everything it was paired with, using conservative advancement: GJK says
+ *  how far apart the two shapes are, and the body can safely move that far
+ *  towards the other one before checking again
+ *
+ *  A body that hits something is stopped just inside it, so the normal
+ *  narrowphase finds a shallow contact and the solver deals with it like
+ *  any other
+ * ================================= */
+#pragma once
+
+#include <darray.h>
+#include <vector3.h>
+
+class PhysicsBody;
+
+class CCD
+{
+public:
+	/***
+	 * @brief Checks whether a body is moving fast enough to need sweeping,
+	 *			which is when it moves further in a step than the thinnest
+	 *			part of its collider
+	 *
+	 * @param body Body to check
+	 * @param delta Length of the step
+	 * @return Whether or not it should be swept
+	 */
+	static bool isFast(PhysicsBody* body, float delta);
+
+	/***
+	 * @brief Sweeps a body from where it was at the start of the step to
+	 *			where it is now against a set of other bodies, and moves it
+	 *			back to the first one it hits
+	 *			Anything it hit sideways it keeps sliding along
+	 *
+	 * @param body Body that's just been integrated
+	 * @param others Bodies that are near where it moved through
+	 * @param delta Length of the step it was integrated over
+	 * @return Whether or not it hit anything
+	 */
+	static bool sweep(PhysicsBody* body, DArray<PhysicsBody*>& others,
+		float delta);
+
+	/***
+	 * @brief Finds when a body moving in a straight line first touches
+	 *			another one that's standing still
+	 *			The body is moved around while this runs, and put back after
+	 *
+	 * @param a Body that's moving, it starts at its position minus motion
+	 *			and ends at its position
+	 * @param b Body it might hit
+	 * @param motion How far a moves
+	 * @param timeOut How far through the motion they touch, from 0 to 1
+	 * @param normalOut Direction from a towards b when they touch
+	 * @param distOut How far apart they still are at that time
+	 * @return Whether or not they touch before a gets to the end
+	 */
+	static bool timeOfImpact(PhysicsBody* a, PhysicsBody* b,
+		Vector3 const& motion, float& timeOut, Vector3& normalOut,
+		float& distOut);
+};
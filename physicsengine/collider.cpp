@@ -4,55 +4,107 @@
  * ================================= */
 #include "collider.h"
 
-#include <Gizmos.h>
-#include <glm/glm.hpp>
+#include <cmath>
 
-#include "util.h"
-#include "shapes.h"
+#include "collideraabb.h"
+#include "collidercone.h"
+#include "collidercylinder.h"
+#include "collidersphere.h"
 #include "physicsbody.h"
+#include "physicsdebug.h"
 
 // draws a small sphere at each point of the collider
-void Collider::drawPoints()
+void Collider::drawPoints(PhysicsDebugDraw* draw)
 {
+	// can't draw at the body's position if there's no body
+	if (!body || !draw)
+		return;
+
+	// the body keeps our points where it is
+	Vector3* worldPoints = body->getWorldPoints();
 	for (int i = 0; i < points.getCount(); ++i)
 	{
-		Vector3 p = points[i];
-		Matrix4 m;
-		m.setPosition(p);
-
-		// translate the point with the body
-		Matrix4 transformed = body->getTransformMatrix() * m;
+		Vector3 p = worldPoints[i];
 
 		// draw a nice red sphere
 		// (which is sometimes transparent when there's a lot of gizmos)
-		drawSphere(Vector3(), 0.05f, Vector4(1, 0, 0, 1), &transformed,
-			8, 8, true, Vector4(1, 0, 0, 1));
+		draw->drawSphere(p, 0.05f, Vector4(1, 0, 0, 1));
 	}
 }
 
 // draws a line from the center of the collider in the direction of each
 // normal
-void Collider::drawNormals()
+void Collider::drawNormals(PhysicsDebugDraw* draw)
 {
 	// can't draw at the body's position if there's no body
-	if (!body)
+	if (!body || !draw)
 		return;
 
 	// grab the center of the body to use as the origin point for lines
-	glm::vec3 p1 = toVec3(body->getPosition());
+	Vector3 p1 = body->getPosition();
 
 	for (int i = 0; i < normals.getCount(); ++i)
 	{
-		Matrix4 m;
-		// extend normals out 1.5 units
-		m.setPosition(normals[i] * 1.5f);
+		// extend normals out 1.5 units and translate it with its body
+		Vector3 p2 = body->transformPoint(normals[i] * 1.5f);
 
-		// translate it with its body
-		m = body->getTransformMatrix() * m;
+		// draw a nice blue line
+		draw->drawLine(p1, p2, Vector4(0, 0, 1, 1));
+	}
+}
 
-		glm::vec3 p2 = toVec3(m.getPosition());
+Vector3 Collider::getSupport(Vector3 const& dir)
+{
+	Vector3 d = dir;
+	// how far the direction points out sideways from the y axis, for the
+	// round shapes
+	float sideways = sqrtf(d.x * d.x + d.z * d.z);
 
-		// draw a nice blue line
-		aie::Gizmos::addLine(p1, p2, glm::vec4(0, 0, 1, 1));
+	switch (type)
+	{
+	case COLLIDER_AABB:
+	{
+		// whichever corner is on the same side on every axis
+		Vector3 ext = ((ColliderAABB*)this)->extents;
+		return Vector3(d.x < 0.0f ? -ext.x : ext.x,
+			d.y < 0.0f ? -ext.y : ext.y, d.z < 0.0f ? -ext.z : ext.z);
+	}
+	case COLLIDER_SPHERE:
+	{
+		auto sphere = (ColliderSphere*)this;
+		float length = d.magnitude();
+		if (length <= 0.0f)
+			return sphere->center;
+		return sphere->center + d * (sphere->radius / length);
+	}
+	case COLLIDER_CYLINDER:
+	{
+		// a point on the rim of the top or bottom
+		auto cylinder = (ColliderCylinder*)this;
+		float h = cylinder->height / 2.0f;
+		float y = d.y < 0.0f ? -h : h;
+		if (sideways <= 0.0f)
+			return Vector3(0.0f, y, 0.0f);
+		float scale = cylinder->radius / sideways;
+		return Vector3(d.x * scale, y, d.z * scale);
+	}
+	case COLLIDER_CONE:
+	{
+		auto cone = (ColliderCone*)this;
+		float h = cone->height / 2.0f;
+
+		// the tip wins if the direction is steeper than the cone's side,
+		// otherwise it's somewhere on the rim of the base
+		float slant = sqrtf(cone->radius * cone->radius +
+			cone->height * cone->height);
+		if (d.y > d.magnitude() * (cone->radius / slant))
+			return Vector3(0.0f, h, 0.0f);
+		if (sideways <= 0.0f)
+			return Vector3(0.0f, -h, 0.0f);
+		float scale = cone->radius / sideways;
+		return Vector3(d.x * scale, -h, d.z * scale);
+	}
+	default:
+		return Vector3();
 	}
 }
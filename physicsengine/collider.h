@@ -8,17 +8,24 @@
 #include <vector3.h>
 
 class PhysicsBody;
+class PhysicsDebugDraw;
 
 enum ColliderType
 {
 	COLLIDER_AABB,
 	COLLIDER_SPHERE,
 	COLLIDER_CYLINDER,
-	COLLIDER_CONE
+	COLLIDER_CONE,
+
+	// number of collider types, not a type itself
+	COLLIDER_TYPE_COUNT
 };
 
 struct Collider
 {
+	// the body sets itself once it's given the collider
+	Collider() : body(nullptr) {}
+
 	ColliderType type;
 	// keep track of the body it's attached to
 	PhysicsBody* body;
@@ -27,7 +34,18 @@ struct Collider
 	DArray<Vector3> points;
 	DArray<Vector3> normals;
 
+	// a box around the actual shape in the collider's own space, set by
+	// each collider type, so the body can size its broad box from this
+	// instead of going through every point
+	Vector3 boundsCenter;
+	Vector3 boundsExtents;
+
 	// ability to draw that information for debug 
-	void drawPoints();
-	void drawNormals();
+	void drawPoints(PhysicsDebugDraw* draw);
+	void drawNormals(PhysicsDebugDraw* draw);
+
+	// gets the point of the actual shape (not its points) that's furthest
+	// in a direction, both in the collider's own space
+	// this is all GJK needs to know about a shape
+	Vector3 getSupport(Vector3 const& dir);
 };
@@ -4,15 +4,16 @@
  * ================================= */
 #include "collideraabb.h"
 
+#include <cmath>
 #include <matrix4.h>
 
-#include "util.h"
 #include "physicsbody.h"
 
 ColliderAABB::ColliderAABB(Vector3 const& ext)
 {
 	extents = ext;
 	type = COLLIDER_AABB;
+	boundsExtents = ext;
 
 	// grab all the corners (super ugly, sorry)
 	for (int i = -1; i <= 1; i += 2)
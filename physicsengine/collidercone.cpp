@@ -7,6 +7,8 @@
 #include <math.h>
 #include <gmath.h>
 
+#include "physicsbody.h"
+
 ColliderCone::ColliderCone(float height, float radius, int segments)
 {
 	type = COLLIDER_CONE;
@@ -18,6 +20,18 @@ void ColliderCone::updateShape(float height, float radius, int segments)
 	normals.clear();
 	points.clear();
 
+	this->height = height;
+	this->radius = radius;
+	boundsExtents = Vector3(radius, height / 2.0f, radius);
+
+	// whatever body we're on has to put our new points in the world again,
+	// and its broad box is a different size now
+	if (body)
+	{
+		body->setShapeDirty();
+		body->updateBroadExtents();
+	}
+
 	// how many radians each segment takes up in the base of the cone
 	float segmentSize = (2.0f * PI) / segments;
 
@@ -14,4 +14,10 @@ struct ColliderCone : public Collider
 	// implemented because we needed to dynamically change the UFO beam's
 	// shape
 	void updateShape(float height, float radius, int segments);
+
+	// the actual round shape, the points and normals are only a polygon
+	// version of it
+	// the tip is at the top and the base is at the bottom
+	float height;
+	float radius;
 };
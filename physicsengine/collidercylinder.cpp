@@ -10,6 +10,9 @@
 ColliderCylinder::ColliderCylinder(float height, float radius, int segments)
 {
 	type = COLLIDER_CYLINDER;
+	this->height = height;
+	this->radius = radius;
+	boundsExtents = Vector3(radius, height / 2.0f, radius);
 
 	// how many radians each segment takes up
 	float segmentSize = (2.0f * PI) / segments;
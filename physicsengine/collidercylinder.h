@@ -9,4 +9,9 @@
 struct ColliderCylinder : public Collider
 {
 	ColliderCylinder(float height, float radius, int segments);
+
+	// the actual round shape, the points and normals are only a polygon
+	// version of it
+	float height;
+	float radius;
 };
\ No newline at end of file
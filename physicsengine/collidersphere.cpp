@@ -4,7 +4,7 @@
  * ================================= */
 #include "collidersphere.h"
 
-#include <glm/glm.hpp>
+#include <math.h>
 #include <gmath.h>
 
 ColliderSphere::ColliderSphere(Vector3 const& c, float r, int rows, int cols)
@@ -12,10 +12,10 @@ ColliderSphere::ColliderSphere(Vector3 const& c, float r, int rows, int cols)
 	center = c;
 	radius = r;
 	type = COLLIDER_SPHERE;
+	boundsCenter = c;
+	boundsExtents = Vector3(r, r, r);
 
 	// copied from Gizmos::addsphere
-	using namespace glm;
-
 	const float longMin = 0.0f;
 	const float longMax = 360.0f;
 	const float latMin = -90.0f;
@@ -47,12 +47,11 @@ ColliderSphere::ColliderSphere(Vector3 const& c, float r, int rows, int cols)
 			float ratioAroundYAxis = float(col) * invColumns;
 			float theta = ratioAroundYAxis * longitudinalRange +
 				(longMin * DEG2RAD);
-			vec3 v4Point(-z * sinf(theta), y, -z * cosf(theta));
-			vec3 v4Normal(inverseRadius * v4Point.x,
-				inverseRadius * v4Point.y, inverseRadius * v4Point.z);
+			Vector3 v4Point(-z * sinf(theta), y, -z * cosf(theta));
+			Vector3 v4Normal = v4Point * inverseRadius;
 
-			points.add(Vector3(v4Point.x, v4Point.y, v4Point.z));
-			normals.add(Vector3(v4Normal.x, v4Normal.y, v4Normal.z));
+			points.add(v4Point);
+			normals.add(v4Normal);
 		}
 	}
 }
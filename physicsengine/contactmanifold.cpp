@@ -0,0 +1,61 @@
+/* =================================
+ *  ContactManifold
+ *  Remembers how hard a pair of bodies has been pushed apart
+ * ================================= */
+#include "contactmanifold.h"
+
+#include "physicsbody.h"
+
+ContactManifold::ContactManifold()
+	: a(nullptr), b(nullptr), normalImpulse(0.0f), lastStep(-1)
+{
+}
+
+void ContactManifold::update(PhysicsContact const& contact, int step)
+{
+	// start over if the bodies have swapped around, or the normal has
+	// flipped, since the old impulse was pushing the wrong way
+	if (contact.a != a || contact.b != b ||
+		normal.dot(contact.axis) < 0.9f)
+		normalImpulse = 0.0f;
+
+	a = contact.a;
+	b = contact.b;
+	normal = contact.axis;
+	lastStep = step;
+}
+
+void ContactManifold::warmStart()
+{
+	if (normalImpulse > 0.0f)
+		applyImpulse(normalImpulse);
+}
+
+void ContactManifold::solveVelocity()
+{
+	float invMass = a->getInverseMass() + b->getInverseMass();
+	if (invMass <= 0.0f)
+		return;
+
+	// speed the bodies are moving towards each other
+	float approach = (a->getVelocity() - b->getVelocity()).dot(normal);
+
+	// contacts can only ever push, so the total impulse can't go negative
+	float impulse = -approach / invMass;
+	float total = normalImpulse + impulse;
+	if (total < 0.0f)
+		total = 0.0f;
+
+	impulse = total - normalImpulse;
+	normalImpulse = total;
+
+	applyImpulse(impulse);
+}
+
+void ContactManifold::applyImpulse(float impulse)
+{
+	Vector3 push = normal * impulse;
+	a->setVelocity(a->getVelocity() + push * a->getInverseMass());
+	if (!b->isStatic())
+		b->setVelocity(b->getVelocity() - push * b->getInverseMass());
+}
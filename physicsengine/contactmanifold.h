@@ -0,0 +1,68 @@
+/* =================================
+ *  ContactManifold
+ *  Remembers how hard a pair of bodies has been pushed apart over the last
+ *  few steps, so the solver can start from where it left off last step
+ *  instead of from nothing
+ *
+ *  Contacts only ever push bodies along (they don't make them spin), so
+ *  every point two bodies touch at would push the same way with the same
+ *  strength. Because of that this keeps one impulse for the whole pair
+ *  rather than a point each, which can be split up into points with their
+ *  own anchors once contacts can rotate bodies
+ *
+ *  The PhysicsManager keeps one for each pair of touching bodies, refreshes
+ *  it with the contact the narrowphase finds every step and throws it away
+ *  once the bodies stop touching
+ * ================================= */
+#pragma once
+
+#include <vector3.h>
+
+class PhysicsBody;
+struct PhysicsContact;
+
+struct ContactManifold
+{
+	// the body that found the contacts and the body it found them with
+	PhysicsBody* a;
+	PhysicsBody* b;
+
+	// points from b towards a
+	Vector3 normal;
+
+	// total impulse pushed along the normal so far, kept between steps for
+	// warm starting
+	float normalImpulse;
+
+	// last step a contact was found for this pair
+	int lastStep;
+
+	ContactManifold();
+
+	/***
+	 * @brief Refreshes the manifold with the contact found this step
+	 *			The impulse is kept unless the bodies have swapped around or
+	 *			the normal has turned too far for it to still be any use
+	 *
+	 * @param contact Contact found for this pair this step
+	 * @param step Number of the current step
+	 */
+	void update(PhysicsContact const& contact, int step);
+
+	/***
+	 * @brief Applies the impulse from last step again, which gets the
+	 *			bodies most of the way to where the solver will end up
+	 */
+	void warmStart();
+
+	/***
+	 * @brief Runs one iteration of sequential impulses, stopping the bodies
+	 *			from moving into each other
+	 *			Static bodies are never touched
+	 */
+	void solveVelocity();
+
+private:
+	// applies an impulse along the normal to both bodies
+	void applyImpulse(float impulse);
+};
@@ -9,13 +9,17 @@
 #include <glm/glm.hpp>
 
 #include "physicsmanager.h"
+#include "physicsthread.h"
+#include "gizmodebugdraw.h"
 
  // states
 #include "basestate.h"
 #include "gamestate.h"
 #include "demostate.h"
 
-Game::Game() {}
+Game::Game()
+	: m_stepper(FIXED_TIMESTEP, MAX_STEPS_PER_FRAME),
+	m_physicsThread(nullptr) {}
 Game::~Game() {}
 
 bool Game::startup()
@@ -24,6 +28,11 @@ bool Game::startup()
 
 	// make singleton instance
 	PhysicsManager::create();
+	// and let it draw its debug information with gizmos
+	// (unless it's on another thread, gizmos can only be added from this one)
+	m_debugDraw = new GizmoDebugDraw();
+	if (!USE_PHYSICS_THREAD)
+		PhysicsManager::getInstance()->setDebugDraw(m_debugDraw);
 
 	// put a sky colour as the background colour
 	setBackgroundColour(0.3f, 0.6f, 0.9f);
@@ -38,15 +47,28 @@ bool Game::startup()
 
 	changeState(GAMESTATE_GAME);
 
-	m_accumulatedDelta = 0.0f;
+	m_stepper.reset();
+
+	// the first state is set up, so it's safe to start stepping
+	if (USE_PHYSICS_THREAD)
+	{
+		m_physicsThread = new PhysicsThread(FIXED_TIMESTEP,
+			MAX_STEPS_PER_FRAME);
+		m_physicsThread->start();
+	}
 
 	return true;
 }
 
 void Game::shutdown()
 {
+	// has to stop before there's nothing left for it to step
+	delete m_physicsThread;
+	m_physicsThread = nullptr;
+
 	aie::Gizmos::destroy();
 	PhysicsManager::destroy();
+	delete m_debugDraw;
 
 	// things can be deleted in onLeave so make sure to call that
 	if (m_currentState)
@@ -58,24 +80,54 @@ void Game::shutdown()
 
 void Game::update(float deltaTime)
 {
-	PhysicsManager* physics = PhysicsManager::getInstance();
-
-	// attempt to give the physics system a fixed timestep
-	m_accumulatedDelta += deltaTime;
-	if (m_accumulatedDelta >= FIXED_TIMESTEP) {
+	// everything is drawn again every frame, even frames that don't step
+	// (the physics debug drawing is kept until the next step, see below)
+	aie::Gizmos::clear();
+
+	if (m_physicsThread)
+	{
+		// physics steps by itself, the state just has to keep it from
+		// stepping while it's changing things
+		m_physicsThread->lock();
 		if (m_currentState)
-			m_currentState->update(FIXED_TIMESTEP);
-
-		physics->update(FIXED_TIMESTEP);
-		m_accumulatedDelta -= FIXED_TIMESTEP;
+			m_currentState->update(deltaTime);
+		m_physicsThread->unlock();
+	}
+	else
+	{
+		updateFixed(deltaTime);
 	}
 
+	// whatever the last step drew, so it doesn't flicker on frames that
+	// don't step
+	m_debugDraw->draw();
+
 	aie::Input* input = aie::Input::getInstance();
 
 	if (input->wasKeyPressed(aie::INPUT_KEY_ESCAPE))
 		this->quit();
 }
 
+void Game::updateFixed(float deltaTime)
+{
+	PhysicsManager* physics = PhysicsManager::getInstance();
+
+	// give the physics system a fixed timestep, running as many steps as it
+	// takes to keep up with however long the frame took
+	int steps = m_stepper.advance(deltaTime);
+	for (int i = 0; i < steps; ++i)
+	{
+		// only the last step's debug information is kept
+		m_debugDraw->clear();
+
+		// step physics first so the state sees where everything ended up
+		physics->update(FIXED_TIMESTEP);
+
+		if (m_currentState)
+			m_currentState->update(FIXED_TIMESTEP);
+	}
+}
+
 void Game::draw()
 {
 	clearScreen();
@@ -86,6 +138,9 @@ void Game::draw()
 
 void Game::changeState(States state)
 {
+	// states only change during update, which already holds the physics
+	// thread's lock if there is one
+
 	// put this here instead of putting it in EVERY state's onLeave
 	PhysicsManager::getInstance()->clear();
 
@@ -5,9 +5,12 @@
 #pragma once
 
 #include <darray.h>
+#include <fixedstepper.h>
 #include <Application.h>
 
 class BaseState;
+class GizmoDebugDraw;
+class PhysicsThread;
 
 enum States
 {
@@ -18,6 +21,12 @@ enum States
 };
 
 #define FIXED_TIMESTEP 0.016f
+// most physics steps run in one frame, if frames are slower than this can
+// keep up with the game slows down instead of taking longer and longer
+#define MAX_STEPS_PER_FRAME 5
+// steps physics on its own thread instead of in update, drawing is then
+// done from the snapshots it publishes and there's no physics debug drawing
+#define USE_PHYSICS_THREAD false
 
 class Game : public aie::Application
 {
@@ -29,16 +38,29 @@ public:
 	virtual void shutdown();
 
 	virtual void update(float deltaTime);
+	// steps physics and the state together in fixed steps
+	void updateFixed(float deltaTime);
 	virtual void draw();
 
 	// state controls
 	void changeState(States state);
 	BaseState* getCurrentState();
 
+	// how far between the last two physics steps the current time is, from
+	// 0 to 1, for drawing things where they'd be right now
+	float getInterpolation() { return m_stepper.getAlpha(); }
+
+	// thread physics is being stepped on, null if it's stepped in update
+	PhysicsThread* getPhysicsThread() { return m_physicsThread; }
+
 protected:
 	BaseState* m_currentState;
 	DArray<BaseState*> m_states;
 
-	float m_accumulatedDelta;
+	// splits up frame time into physics steps
+	FixedStepper m_stepper;
+	PhysicsThread* m_physicsThread;
+
+	GizmoDebugDraw* m_debugDraw;
 
 };
\ No newline at end of file
@@ -132,6 +132,8 @@ Box* GameState::spawnRandomBox()
 
 	b->getBody()->setFriction(0.0f);
 	b->getBody()->setFrictionMode(FRICTION_MIN);
+	// small boxes come out fast enough to go through the floor in a step
+	b->getBody()->setContinuous(true);
 
 	// get random velocity
 	const float vr = 3.0f;
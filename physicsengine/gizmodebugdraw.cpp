@@ -0,0 +1,62 @@
+/* =================================
+ *  GizmoDebugDraw
+ *  Draws the physics debug information using the bootstrap's Gizmos
+ * ================================= */
+#include "gizmodebugdraw.h"
+
+#include <Gizmos.h>
+
+#include "util.h"
+#include "shapes.h"
+
+void GizmoDebugDraw::clear()
+{
+	// clearing keeps the memory, so steps don't allocate once they've drawn
+	// this much
+	m_lines.clear();
+	m_boxes.clear();
+	m_spheres.clear();
+}
+
+void GizmoDebugDraw::draw()
+{
+	for (int i = 0; i < m_lines.getCount(); ++i)
+	{
+		Line& line = m_lines[i];
+		aie::Gizmos::addLine(toVec3(line.start), toVec3(line.end),
+			toVec4(line.color));
+	}
+
+	for (int i = 0; i < m_boxes.getCount(); ++i)
+	{
+		Shape& box = m_boxes[i];
+		aie::Gizmos::addAABB(toVec3(box.center), toVec3(box.size),
+			toVec4(box.color));
+	}
+
+	for (int i = 0; i < m_spheres.getCount(); ++i)
+	{
+		// outline it in the same colour so it shows up as a solid dot
+		Shape& sphere = m_spheres[i];
+		::drawSphere(sphere.center, sphere.size.x, sphere.color, nullptr,
+			8, 8, true, sphere.color);
+	}
+}
+
+void GizmoDebugDraw::drawLine(Vector3 const& start, Vector3 const& end,
+	Vector4 const& color)
+{
+	m_lines.add({ start, end, color });
+}
+
+void GizmoDebugDraw::drawBox(Vector3 const& center, Vector3 const& extents,
+	Vector4 const& color)
+{
+	m_boxes.add({ center, extents, color });
+}
+
+void GizmoDebugDraw::drawSphere(Vector3 const& center, float radius,
+	Vector4 const& color)
+{
+	m_spheres.add({ center, Vector3(radius, radius, radius), color });
+}
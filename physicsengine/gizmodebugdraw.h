@@ -0,0 +1,49 @@
+/* =================================
+ *  GizmoDebugDraw
+ *  Draws the physics debug information using the bootstrap's Gizmos
+ *
+ *  Gizmos are cleared every frame, but the physics only draws when it
+ *  steps, which isn't every frame. So everything the physics draws is kept
+ *  here until the next step, and added to the Gizmos again each frame
+ * ================================= */
+#pragma once
+
+#include <darray.h>
+
+#include "physicsdebug.h"
+
+class GizmoDebugDraw : public PhysicsDebugDraw
+{
+public:
+	// throws away everything that's been drawn, for just before a step
+	void clear();
+	// adds everything the last step drew to the Gizmos
+	void draw();
+
+	void drawLine(Vector3 const& start, Vector3 const& end,
+		Vector4 const& color) override;
+	void drawBox(Vector3 const& center, Vector3 const& extents,
+		Vector4 const& color) override;
+	void drawSphere(Vector3 const& center, float radius,
+		Vector4 const& color) override;
+
+private:
+	struct Line
+	{
+		Vector3 start;
+		Vector3 end;
+		Vector4 color;
+	};
+
+	// boxes use size as their extents, spheres use its x as their radius
+	struct Shape
+	{
+		Vector3 center;
+		Vector3 size;
+		Vector4 color;
+	};
+
+	DArray<Line> m_lines;
+	DArray<Shape> m_boxes;
+	DArray<Shape> m_spheres;
+};
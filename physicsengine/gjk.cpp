@@ -0,0 +1,545 @@
+/* =================================
+ *  GJK
+ *  Collision and distance tests between any two convex colliders, using
+ *  just their support functions
+ * ================================= */
+#include "gjk.h"
+
+#include <cmath>
+
+#include "collider.h"
+#include "physicsbody.h"
+
+// most times GJK will go around before giving up
+#define GJK_MAX_ITERATIONS 32
+// closest points this close to the origin count as touching it
+#define GJK_EPSILON 1e-10f
+// stop once a step gets less than this much (relatively) closer
+#define GJK_TOLERANCE 1e-6f
+
+// limits on how big the EPA shape can get
+#define EPA_MAX_ITERATIONS 64
+#define EPA_MAX_VERTS 64
+#define EPA_MAX_FACES 128
+// stop once the shape grows less than this much in a step
+#define EPA_TOLERANCE 1e-4f
+
+// furthest point of a body's collider in a world space direction
+static Vector3 worldSupport(PhysicsBody* body, Vector3 const& dir)
+{
+	Vector3 local = body->inverseRotatePoint(dir);
+	return body->transformPoint(body->getCollider()->getSupport(local));
+}
+
+GJK::Vertex GJK::support(PhysicsBody* a, PhysicsBody* b, Vector3 const& dir)
+{
+	Vertex v;
+	v.a = worldSupport(a, dir);
+	v.b = worldSupport(b, Vector3(-dir.x, -dir.y, -dir.z));
+	v.w = v.a - v.b;
+	return v;
+}
+
+// how much of each corner of a triangle makes up a point on it
+static void barycentric(Vector3 a, Vector3 b, Vector3 c, Vector3 p,
+	float* weights)
+{
+	Vector3 v0 = b - a;
+	Vector3 v1 = c - a;
+	Vector3 v2 = p - a;
+
+	float d00 = v0.dot(v0);
+	float d01 = v0.dot(v1);
+	float d11 = v1.dot(v1);
+	float d20 = v2.dot(v0);
+	float d21 = v2.dot(v1);
+
+	float denom = d00 * d11 - d01 * d01;
+	if (fabsf(denom) < 1e-12f)
+	{
+		// flat triangle, just use the first corner
+		weights[0] = 1.0f;
+		weights[1] = weights[2] = 0.0f;
+		return;
+	}
+
+	weights[1] = (d11 * d20 - d01 * d21) / denom;
+	weights[2] = (d00 * d21 - d01 * d20) / denom;
+	weights[0] = 1.0f - weights[1] - weights[2];
+}
+
+Vector3 GJK::closestToOrigin(Simplex& simplex, float* weights)
+{
+	Vertex* v = simplex.verts;
+
+	if (simplex.count == 1)
+	{
+		weights[0] = 1.0f;
+		return v[0].w;
+	}
+
+	if (simplex.count == 2)
+	{
+		Vector3 a = v[0].w;
+		Vector3 ab = v[1].w - a;
+
+		float length = ab.dot(ab);
+		float t = length > 0.0f ? -a.dot(ab) / length : 0.0f;
+		if (t <= 0.0f)
+		{
+			simplex.count = 1;
+			weights[0] = 1.0f;
+			return a;
+		}
+		if (t >= 1.0f)
+		{
+			v[0] = v[1];
+			simplex.count = 1;
+			weights[0] = 1.0f;
+			return v[0].w;
+		}
+
+		weights[0] = 1.0f - t;
+		weights[1] = t;
+		return a + ab * t;
+	}
+
+	if (simplex.count == 3)
+	{
+		// works out which part of the triangle (corner, edge or face) the
+		// origin is closest to, from Real-Time Collision Detection
+		Vector3 a = v[0].w;
+		Vector3 b = v[1].w;
+		Vector3 c = v[2].w;
+		Vector3 ab = b - a;
+		Vector3 ac = c - a;
+
+		Vector3 ap = a * -1.0f;
+		float d1 = ab.dot(ap);
+		float d2 = ac.dot(ap);
+		if (d1 <= 0.0f && d2 <= 0.0f)
+		{
+			simplex.count = 1;
+			weights[0] = 1.0f;
+			return a;
+		}
+
+		Vector3 bp = b * -1.0f;
+		float d3 = ab.dot(bp);
+		float d4 = ac.dot(bp);
+		if (d3 >= 0.0f && d4 <= d3)
+		{
+			v[0] = v[1];
+			simplex.count = 1;
+			weights[0] = 1.0f;
+			return b;
+		}
+
+		float vc = d1 * d4 - d3 * d2;
+		if (vc <= 0.0f && d1 >= 0.0f && d3 <= 0.0f)
+		{
+			float t = d1 / (d1 - d3);
+			simplex.count = 2;
+			weights[0] = 1.0f - t;
+			weights[1] = t;
+			return a + ab * t;
+		}
+
+		Vector3 cp = c * -1.0f;
+		float d5 = ab.dot(cp);
+		float d6 = ac.dot(cp);
+		if (d6 >= 0.0f && d5 <= d6)
+		{
+			v[0] = v[2];
+			simplex.count = 1;
+			weights[0] = 1.0f;
+			return c;
+		}
+
+		float vb = d5 * d2 - d1 * d6;
+		if (vb <= 0.0f && d2 >= 0.0f && d6 <= 0.0f)
+		{
+			float t = d2 / (d2 - d6);
+			v[1] = v[2];
+			simplex.count = 2;
+			weights[0] = 1.0f - t;
+			weights[1] = t;
+			return a + ac * t;
+		}
+
+		float va = d3 * d6 - d5 * d4;
+		if (va <= 0.0f && (d4 - d3) >= 0.0f && (d5 - d6) >= 0.0f)
+		{
+			float t = (d4 - d3) / ((d4 - d3) + (d5 - d6));
+			v[0] = v[1];
+			v[1] = v[2];
+			simplex.count = 2;
+			weights[0] = 1.0f - t;
+			weights[1] = t;
+			return b + (c - b) * t;
+		}
+
+		// somewhere on the face
+		float denom = 1.0f / (va + vb + vc);
+		float s = vb * denom;
+		float t = vc * denom;
+		weights[0] = 1.0f - s - t;
+		weights[1] = s;
+		weights[2] = t;
+		return a + ab * s + ac * t;
+	}
+
+	// tetrahedron, check each face the origin is on the outside of
+	static const int faces[4][4] = {
+		{ 0, 1, 2, 3 }, { 0, 2, 3, 1 }, { 0, 3, 1, 2 }, { 1, 3, 2, 0 }
+	};
+
+	bool outside = false;
+	float bestDist = INFINITY;
+	Simplex best;
+	Vector3 bestPoint;
+	float bestWeights[3];
+
+	for (int i = 0; i < 4; ++i)
+	{
+		Vector3 a = v[faces[i][0]].w;
+		Vector3 normal = Vector3::cross(v[faces[i][1]].w - a,
+			v[faces[i][2]].w - a);
+
+		// which side of the face the origin and the last corner are on,
+		// flat tetrahedrons have every face checked
+		float originSide = normal.dot(a * -1.0f);
+		float cornerSide = normal.dot(v[faces[i][3]].w - a);
+		if (originSide * cornerSide < 0.0f || cornerSide * cornerSide < 1e-12f)
+		{
+			outside = true;
+
+			Simplex face;
+			face.count = 3;
+			for (int j = 0; j < 3; ++j)
+				face.verts[j] = v[faces[i][j]];
+
+			float faceWeights[3];
+			Vector3 point = closestToOrigin(face, faceWeights);
+			float dist = point.dot(point);
+			if (dist < bestDist)
+			{
+				bestDist = dist;
+				best = face;
+				bestPoint = point;
+				for (int j = 0; j < face.count; ++j)
+					bestWeights[j] = faceWeights[j];
+			}
+		}
+	}
+
+	// the origin's inside, leave all 4 so the caller knows
+	if (!outside)
+		return Vector3();
+
+	simplex = best;
+	for (int i = 0; i < simplex.count; ++i)
+		weights[i] = bestWeights[i];
+	return bestPoint;
+}
+
+bool GJK::run(PhysicsBody* a, PhysicsBody* b, Simplex& simplex,
+	Vector3& closest, float* weights, bool stopEarly)
+{
+	// start off heading from one body to the other
+	Vector3 dir = a->getPosition() - b->getPosition();
+	if (dir.magnitudeSquared() < GJK_EPSILON)
+		dir = Vector3(1, 0, 0);
+
+	simplex.verts[0] = support(a, b, dir);
+	simplex.count = 1;
+	closest = simplex.verts[0].w;
+	weights[0] = 1.0f;
+
+	for (int i = 0; i < GJK_MAX_ITERATIONS; ++i)
+	{
+		float distSquared = closest.dot(closest);
+		// the origin's on the simplex, so they're just touching
+		if (distSquared < GJK_EPSILON)
+			return true;
+
+		Vertex v = support(a, b, closest * -1.0f);
+
+		// the furthest point towards the origin doesn't get past it, so
+		// there's a gap between them
+		float reach = closest.dot(v.w);
+		if (stopEarly && reach > 0.0f)
+			return false;
+
+		// stop once it stops getting any closer
+		if (distSquared - reach <= distSquared * GJK_TOLERANCE)
+			return false;
+		for (int j = 0; j < simplex.count; ++j)
+			if ((simplex.verts[j].w - v.w).magnitudeSquared() < GJK_EPSILON)
+				return false;
+
+		simplex.verts[simplex.count++] = v;
+		closest = closestToOrigin(simplex, weights);
+
+		// only a tetrahedron with the origin inside keeps all 4
+		if (simplex.count == 4)
+			return true;
+	}
+
+	// didn't settle, so closest is as good as it gets
+	return false;
+}
+
+bool GJK::distance(PhysicsBody* a, PhysicsBody* b, float& distOut,
+	Vector3& pointA, Vector3& pointB)
+{
+	Simplex simplex;
+	Vector3 closest;
+	float weights[4];
+	if (run(a, b, simplex, closest, weights, false))
+		return false;
+
+	// the closest point is made of the same mix of points on each shape
+	pointA = Vector3();
+	pointB = Vector3();
+	for (int i = 0; i < simplex.count; ++i)
+	{
+		pointA += simplex.verts[i].a * weights[i];
+		pointB += simplex.verts[i].b * weights[i];
+	}
+	distOut = closest.magnitude();
+	return true;
+}
+
+bool GJK::intersect(PhysicsBody* a, PhysicsBody* b, float& penOut,
+	Vector3& axisOut, Vector3& pointOut)
+{
+	Simplex simplex;
+	Vector3 closest;
+	float weights[4];
+	if (!run(a, b, simplex, closest, weights, true))
+		return false;
+
+	if (!fillSimplex(a, b, simplex))
+		return false;
+
+	return expand(a, b, simplex, penOut, axisOut, pointOut);
+}
+
+bool GJK::fillSimplex(PhysicsBody* a, PhysicsBody* b, Simplex& simplex)
+{
+	static const Vector3 axes[6] = {
+		Vector3(1, 0, 0), Vector3(-1, 0, 0), Vector3(0, 1, 0),
+		Vector3(0, -1, 0), Vector3(0, 0, 1), Vector3(0, 0, -1)
+	};
+	Vertex* v = simplex.verts;
+
+	// add points in whatever directions give something new, until there's a
+	// tetrahedron that isn't flat
+	if (simplex.count == 1)
+	{
+		for (int i = 0; i < 6; ++i)
+		{
+			Vertex added = support(a, b, axes[i]);
+			if ((added.w - v[0].w).magnitudeSquared() > GJK_EPSILON)
+			{
+				v[simplex.count++] = added;
+				break;
+			}
+		}
+	}
+
+	if (simplex.count == 2)
+	{
+		// any direction at right angles to the line
+		Vector3 line = v[1].w - v[0].w;
+		Vector3 side = Vector3::cross(line, fabsf(line.x) < 0.5f ?
+			Vector3(1, 0, 0) : Vector3(0, 1, 0));
+		Vector3 dirs[4] = { side, side * -1.0f,
+			Vector3::cross(line, side), Vector3::cross(side, line) };
+
+		for (int i = 0; i < 4; ++i)
+		{
+			Vertex added = support(a, b, dirs[i]);
+			Vector3 offLine = Vector3::cross(added.w - v[0].w, line);
+			if (offLine.magnitudeSquared() >
+				GJK_EPSILON * line.magnitudeSquared())
+			{
+				v[simplex.count++] = added;
+				break;
+			}
+		}
+	}
+
+	if (simplex.count == 3)
+	{
+		Vector3 normal = Vector3::cross(v[1].w - v[0].w, v[2].w - v[0].w);
+		Vector3 dirs[2] = { normal, normal * -1.0f };
+
+		for (int i = 0; i < 2; ++i)
+		{
+			Vertex added = support(a, b, dirs[i]);
+			float offPlane = normal.dot(added.w - v[0].w);
+			if (offPlane * offPlane > GJK_EPSILON * normal.magnitudeSquared())
+			{
+				v[simplex.count++] = added;
+				break;
+			}
+		}
+	}
+
+	return simplex.count == 4;
+}
+
+// a triangle on the outside of the EPA shape
+struct EPAFace
+{
+	int a, b, c;
+	// points away from the inside of the shape
+	Vector3 normal;
+	// how far the face is from the origin
+	float dist;
+};
+
+// makes a face out of three corners, keeping their winding
+static bool makeFace(GJK::Vertex* verts, int a, int b, int c, EPAFace& face)
+{
+	Vector3 normal = Vector3::cross(verts[b].w - verts[a].w,
+		verts[c].w - verts[a].w);
+	float length = normal.magnitude();
+	if (length < 1e-8f)
+		return false;
+
+	face.a = a;
+	face.b = b;
+	face.c = c;
+	face.normal = normal / length;
+	face.dist = face.normal.dot(verts[a].w);
+	return true;
+}
+
+bool GJK::expand(PhysicsBody* a, PhysicsBody* b, Simplex& simplex,
+	float& penOut, Vector3& axisOut, Vector3& pointOut)
+{
+	Vertex verts[EPA_MAX_VERTS];
+	int vertCount = 4;
+	for (int i = 0; i < 4; ++i)
+		verts[i] = simplex.verts[i];
+
+	EPAFace faces[EPA_MAX_FACES];
+	int faceCount = 0;
+
+	// the tetrahedron's faces, wound so their normals point outwards
+	static const int start[4][4] = {
+		{ 0, 1, 2, 3 }, { 0, 3, 1, 2 }, { 0, 2, 3, 1 }, { 1, 3, 2, 0 }
+	};
+	for (int i = 0; i < 4; ++i)
+	{
+		EPAFace& face = faces[faceCount];
+		if (!makeFace(verts, start[i][0], start[i][1], start[i][2], face))
+			continue;
+
+		// flip it if it's facing the corner it's across from
+		Vector3 toCorner = verts[start[i][3]].w - verts[face.a].w;
+		if (face.normal.dot(toCorner) > 0.0f)
+			makeFace(verts, face.a, face.c, face.b, face);
+		faceCount++;
+	}
+
+	// edges left behind when faces are taken away
+	int edges[EPA_MAX_FACES * 3][2];
+
+	int closest = -1;
+	for (int iteration = 0; iteration < EPA_MAX_ITERATIONS; ++iteration)
+	{
+		if (faceCount == 0)
+			return false;
+
+		closest = 0;
+		for (int i = 1; i < faceCount; ++i)
+			if (faces[i].dist < faces[closest].dist)
+				closest = i;
+
+		// push the closest face outwards, if it doesn't go anywhere then
+		// that's as far as the shape goes
+		Vertex v = support(a, b, faces[closest].normal);
+		float growth = faces[closest].normal.dot(v.w) - faces[closest].dist;
+		if (growth < EPA_TOLERANCE || vertCount == EPA_MAX_VERTS)
+			break;
+
+		// take away every face the new point can see, keeping the edges
+		// around the hole they leave
+		int edgeCount = 0;
+		for (int i = faceCount - 1; i >= 0; --i)
+		{
+			EPAFace& face = faces[i];
+			if (face.normal.dot(v.w - verts[face.a].w) <= 0.0f)
+				continue;
+
+			int corners[3] = { face.a, face.b, face.c };
+			for (int j = 0; j < 3; ++j)
+			{
+				int from = corners[j];
+				int to = corners[(j + 1) % 3];
+
+				// an edge shared with another face that's going is inside
+				// the hole, not around it
+				bool shared = false;
+				for (int k = 0; k < edgeCount; ++k)
+				{
+					if (edges[k][0] == to && edges[k][1] == from)
+					{
+						edges[k][0] = edges[edgeCount - 1][0];
+						edges[k][1] = edges[edgeCount - 1][1];
+						edgeCount--;
+						shared = true;
+						break;
+					}
+				}
+				if (!shared)
+				{
+					edges[edgeCount][0] = from;
+					edges[edgeCount][1] = to;
+					edgeCount++;
+				}
+			}
+
+			faces[i] = faces[--faceCount];
+		}
+
+		// and fill the hole back in with faces to the new point
+		int added = vertCount++;
+		verts[added] = v;
+		for (int i = 0; i < edgeCount && faceCount < EPA_MAX_FACES; ++i)
+			if (makeFace(verts, edges[i][0], edges[i][1], added,
+				faces[faceCount]))
+				faceCount++;
+		closest = -1;
+	}
+
+	if (closest < 0)
+	{
+		// ran out of iterations, use whatever's closest now
+		if (faceCount == 0)
+			return false;
+		closest = 0;
+		for (int i = 1; i < faceCount; ++i)
+			if (faces[i].dist < faces[closest].dist)
+				closest = i;
+	}
+
+	EPAFace& face = faces[closest];
+
+	// the origin pushed onto the face, made of the same mix of points on a
+	Vector3 onFace = face.normal * face.dist;
+	float weights[3];
+	barycentric(verts[face.a].w, verts[face.b].w, verts[face.c].w, onFace,
+		weights);
+	pointOut = verts[face.a].a * weights[0] + verts[face.b].a * weights[1] +
+		verts[face.c].a * weights[2];
+
+	// a has to move back out the way the face points
+	penOut = face.dist;
+	axisOut = face.normal * -1.0f;
+	return true;
+}
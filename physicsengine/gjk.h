@@ -0,0 +1,85 @@
+/* =================================
+ *  GJK
+ *  Collision and distance tests between any two convex colliders, which
+ *  only need each shape's support function (Collider::getSupport) instead
+ *  of its points, so round shapes are tested exactly and the cost doesn't
+ *  depend on how finely they were built
+ *
+ *  GJK finds how far apart two shapes are, and EPA finds how far into each
+ *  other they are when GJK finds they're overlapping
+ * ================================= */
+#pragma once
+
+#include <vector3.h>
+
+class PhysicsBody;
+
+class GJK
+{
+public:
+	// a point on the edge of the difference between the two shapes, along
+	// with the points on each shape it came from
+	struct Vertex
+	{
+		Vector3 w;
+		Vector3 a;
+		Vector3 b;
+	};
+
+	/***
+	 * @brief Checks if two bodies' colliders overlap and by how much
+	 *
+	 * @param a First body
+	 * @param b Second body
+	 * @param penOut How far they overlap
+	 * @param axisOut Direction a has to move to stop overlapping (points
+	 *			from b towards a)
+	 * @param pointOut Point of a that's deepest into b
+	 * @return Whether or not they overlap
+	 */
+	static bool intersect(PhysicsBody* a, PhysicsBody* b, float& penOut,
+		Vector3& axisOut, Vector3& pointOut);
+
+	/***
+	 * @brief Finds the closest points between two bodies' colliders
+	 *
+	 * @param a First body
+	 * @param b Second body
+	 * @param distOut Distance between the two closest points
+	 * @param pointA Point on a closest to b
+	 * @param pointB Point on b closest to a
+	 * @return False if they're overlapping, in which case there's no
+	 *			distance to give
+	 */
+	static bool distance(PhysicsBody* a, PhysicsBody* b, float& distOut,
+		Vector3& pointA, Vector3& pointB);
+
+private:
+	struct Simplex
+	{
+		Vertex verts[4];
+		int count;
+	};
+
+	// furthest point of the difference between a and b in a direction
+	static Vertex support(PhysicsBody* a, PhysicsBody* b, Vector3 const& dir);
+
+	// runs GJK until it either finds the closest point of the difference to
+	// the origin (false) or finds the origin inside it (true)
+	// stopEarly stops as soon as they're known to be apart, without finding
+	// the actual closest point
+	static bool run(PhysicsBody* a, PhysicsBody* b, Simplex& simplex,
+		Vector3& closest, float* weights, bool stopEarly);
+
+	// finds the point of the simplex closest to the origin and cuts the
+	// simplex down to just the part that point is on
+	// weights are how much of each remaining vertex makes up the point
+	static Vector3 closestToOrigin(Simplex& simplex, float* weights);
+
+	// grows a simplex with the origin on it into a tetrahedron for EPA
+	static bool fillSimplex(PhysicsBody* a, PhysicsBody* b, Simplex& simplex);
+
+	// finds how far the origin is inside the difference
+	static bool expand(PhysicsBody* a, PhysicsBody* b, Simplex& simplex,
+		float& penOut, Vector3& axisOut, Vector3& pointOut);
+};
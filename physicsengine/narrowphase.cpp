@@ -0,0 +1,297 @@
+/* =================================
+ *  Narrowphase
+ *  Collision tests between pairs of colliders, picked from a table by the
+ *  type of each collider
+ * ================================= */
+#include "narrowphase.h"
+
+#include <cmath>
+#include <matrix4.h>
+
+#include "collideraabb.h"
+#include "collidersphere.h"
+#include "gjk.h"
+#include "physicsbody.h"
+
+bool Narrowphase::forceSAT = false;
+
+Narrowphase::CollideFunc
+	Narrowphase::m_table[COLLIDER_TYPE_COUNT][COLLIDER_TYPE_COUNT] =
+{
+	// against:	AABB, sphere, cylinder, cone
+	/* AABB */ { boxVsBox, boxVsSphere, gjk, gjk },
+	/* sphere */ { sphereVsBox, sphereVsSphere, gjk, gjk },
+	/* cylinder */ { gjk, gjk, gjk, gjk },
+	/* cone */ { gjk, gjk, gjk, gjk }
+};
+
+// what's needed to test against a box, grabbed from its body once
+struct Box
+{
+	Vector3 center;
+	// the box's own x, y and z in the world
+	Vector3 axes[3];
+	Vector3 extents;
+};
+
+static Box getBox(PhysicsBody* body)
+{
+	Box box;
+	box.center = body->getPosition();
+
+	Matrix4 rotation = body->getRotationMatrix();
+	for (int i = 0; i < 3; ++i)
+		box.axes[i] = (Vector3)rotation[i];
+
+	box.extents = ((ColliderAABB*)body->getCollider())->extents;
+	return box;
+}
+
+// where the sphere's center is in the world
+static Vector3 getSphereCenter(PhysicsBody* body)
+{
+	return body->transformPoint(((ColliderSphere*)body->getCollider())->center);
+}
+
+static float getSphereRadius(PhysicsBody* body)
+{
+	return ((ColliderSphere*)body->getCollider())->radius;
+}
+
+bool Narrowphase::collide(PhysicsBody* a, PhysicsBody* b,
+	PhysicsContact& contact, int& axisIndex)
+{
+	if (forceSAT)
+		return generic(a, b, contact, axisIndex);
+
+	ColliderType typeA = a->getCollider()->type;
+	ColliderType typeB = b->getCollider()->type;
+	return m_table[typeA][typeB](a, b, contact, axisIndex);
+}
+
+bool Narrowphase::generic(PhysicsBody* a, PhysicsBody* b,
+	PhysicsContact& contact, int& axisIndex)
+{
+	return a->isCollidingSAT(b->getCollider(), contact.penetration,
+		contact.axis, contact.point, axisIndex);
+}
+
+bool Narrowphase::gjk(PhysicsBody* a, PhysicsBody* b,
+	PhysicsContact& contact, int& axisIndex)
+{
+	axisIndex = -1;
+	return GJK::intersect(a, b, contact.penetration, contact.axis,
+		contact.point);
+}
+
+bool Narrowphase::sphereVsSphere(PhysicsBody* a, PhysicsBody* b,
+	PhysicsContact& contact, int& axisIndex)
+{
+	axisIndex = -1;
+
+	Vector3 centerA = getSphereCenter(a);
+	Vector3 centerB = getSphereCenter(b);
+	float radiusA = getSphereRadius(a);
+	float radiusB = getSphereRadius(b);
+
+	Vector3 dif = centerA - centerB;
+	float radii = radiusA + radiusB;
+	float distSquared = dif.magnitudeSquared();
+	if (distSquared >= radii * radii)
+		return false;
+
+	// spheres right on top of each other get pushed straight up
+	float dist = sqrtf(distSquared);
+	contact.axis = dist > 0.0001f ? dif / dist : Vector3(0, 1, 0);
+	contact.penetration = radii - dist;
+	contact.point = centerA - contact.axis * radiusA;
+	return true;
+}
+
+// finds how far into a box a sphere is, with the normal pointing from the
+// box towards the sphere and the point on the box nearest the sphere
+static bool sphereInBox(Vector3 center, float radius, Box& box,
+	float& penOut, Vector3& normalOut, Vector3& pointOut)
+{
+	Vector3 dif = center - box.center;
+
+	// clamp the center into the box along each of its axes
+	float local[3];
+	bool inside = true;
+	Vector3 closest = box.center;
+	for (int i = 0; i < 3; ++i)
+	{
+		local[i] = dif.dot(box.axes[i]);
+
+		float clamped = local[i];
+		if (clamped > box.extents[i])
+		{
+			clamped = box.extents[i];
+			inside = false;
+		}
+		else if (clamped < -box.extents[i])
+		{
+			clamped = -box.extents[i];
+			inside = false;
+		}
+		closest += box.axes[i] * clamped;
+	}
+
+	if (!inside)
+	{
+		Vector3 out = center - closest;
+		float distSquared = out.magnitudeSquared();
+		if (distSquared >= radius * radius)
+			return false;
+
+		float dist = sqrtf(distSquared);
+		normalOut = out / dist;
+		penOut = radius - dist;
+		pointOut = closest;
+		return true;
+	}
+
+	// the center's inside the box, so push it out the closest face
+	int face = 0;
+	float faceDist = INFINITY;
+	for (int i = 0; i < 3; ++i)
+	{
+		float d = box.extents[i] - fabsf(local[i]);
+		if (d < faceDist)
+		{
+			faceDist = d;
+			face = i;
+		}
+	}
+
+	normalOut = local[face] < 0.0f ? box.axes[face] * -1.0f : box.axes[face];
+	penOut = radius + faceDist;
+	pointOut = center + normalOut * faceDist;
+	return true;
+}
+
+bool Narrowphase::sphereVsBox(PhysicsBody* a, PhysicsBody* b,
+	PhysicsContact& contact, int& axisIndex)
+{
+	axisIndex = -1;
+
+	Vector3 center = getSphereCenter(a);
+	float radius = getSphereRadius(a);
+	Box box = getBox(b);
+
+	Vector3 normal, boxPoint;
+	if (!sphereInBox(center, radius, box, contact.penetration, normal,
+		boxPoint))
+		return false;
+
+	// the normal already points from the box to the sphere
+	contact.axis = normal;
+	contact.point = center - normal * radius;
+	return true;
+}
+
+bool Narrowphase::boxVsSphere(PhysicsBody* a, PhysicsBody* b,
+	PhysicsContact& contact, int& axisIndex)
+{
+	axisIndex = -1;
+
+	Box box = getBox(a);
+	Vector3 normal;
+	if (!sphereInBox(getSphereCenter(b), getSphereRadius(b), box,
+		contact.penetration, normal, contact.point))
+		return false;
+
+	// flip it so it points from the sphere to the box
+	contact.axis = normal * -1.0f;
+	return true;
+}
+
+// how much two boxes overlap along an axis, negative if they don't
+static float boxOverlap(Box& a, Box& b, Vector3& axis, Vector3& dif)
+{
+	float radiusA = 0.0f;
+	float radiusB = 0.0f;
+	for (int i = 0; i < 3; ++i)
+	{
+		radiusA += a.extents[i] * fabsf(a.axes[i].dot(axis));
+		radiusB += b.extents[i] * fabsf(b.axes[i].dot(axis));
+	}
+	return radiusA + radiusB - fabsf(dif.dot(axis));
+}
+
+bool Narrowphase::boxVsBox(PhysicsBody* a, PhysicsBody* b,
+	PhysicsContact& contact, int& axisIndex)
+{
+	Box boxA = getBox(a);
+	Box boxB = getBox(b);
+	Vector3 dif = boxA.center - boxB.center;
+
+	// 3 face axes from each box, then every edge crossed with every edge
+	Vector3 axes[15];
+	bool valid[15];
+	for (int i = 0; i < 3; ++i)
+	{
+		axes[i] = boxA.axes[i];
+		axes[3 + i] = boxB.axes[i];
+		valid[i] = valid[3 + i] = true;
+	}
+	for (int i = 0; i < 3; ++i)
+	{
+		for (int j = 0; j < 3; ++j)
+		{
+			// edges that are (nearly) parallel don't make an axis, and the
+			// face axes already cover that case
+			Vector3 axis = Vector3::cross(boxA.axes[i], boxB.axes[j]);
+			float length = axis.magnitude();
+			int index = 6 + i * 3 + j;
+			valid[index] = length > 0.0001f;
+			axes[index] = valid[index] ? axis / length : axis;
+		}
+	}
+
+	// try whatever separated them last time first
+	if (axisIndex >= 0 && axisIndex < 15 && valid[axisIndex] &&
+		boxOverlap(boxA, boxB, axes[axisIndex], dif) <= 0.0f)
+		return false;
+
+	int best = -1;
+	float bestOverlap = INFINITY;
+	for (int i = 0; i < 15; ++i)
+	{
+		if (!valid[i])
+			continue;
+
+		float overlap = boxOverlap(boxA, boxB, axes[i], dif);
+		if (overlap <= 0.0f)
+		{
+			axisIndex = i;
+			return false;
+		}
+
+		// edge axes have to be a fair bit better than a face axis to be
+		// used, otherwise boxes resting flat flicker between them
+		float compare = i < 6 ? overlap : overlap * 1.05f;
+		if (compare < bestOverlap)
+		{
+			bestOverlap = compare;
+			best = i;
+		}
+	}
+
+	axisIndex = best;
+	Vector3 axis = axes[best];
+	if (dif.dot(axis) < 0.0f)
+		axis = axis * -1.0f;
+
+	contact.axis = axis;
+	contact.penetration = boxOverlap(boxA, boxB, axis, dif);
+
+	// a's corner furthest into b
+	contact.point = boxA.center;
+	for (int i = 0; i < 3; ++i)
+	{
+		float side = boxA.axes[i].dot(axis) > 0.0f ? -1.0f : 1.0f;
+		contact.point += boxA.axes[i] * (boxA.extents[i] * side);
+	}
+	return true;
+}
@@ -0,0 +1,67 @@
+/* =================================
+ *  Narrowphase
+ *  Collision tests between pairs of colliders, picked from a table by the
+ *  type of each collider
+ *
+ *  Spheres and boxes have exact tests which don't care how many points the
+ *  collider was built with, and cylinders and cones go through GJK using
+ *  their actual round shapes
+ *  The generic SAT against every point and normal
+ *  (PhysicsBody::isCollidingSAT) is still around to compare against
+ * ================================= */
+#pragma once
+
+#include "collider.h"
+
+class PhysicsBody;
+struct PhysicsContact;
+
+class Narrowphase
+{
+public:
+	// sends every pair through the generic SAT, for comparing against it
+	static bool forceSAT;
+
+	/***
+	 * @brief Checks if two bodies' colliders are touching, using the best
+	 *			test there is for their types
+	 *
+	 * @param a Body doing the checking, it gets pushed along the axis
+	 * @param b Body being checked against
+	 * @param contact Filled in with the penetration, axis (pointing from b
+	 *			towards a) and deepest point of a if they're touching
+	 * @param axisIndex Axis to try first, comes back as the axis that
+	 *			decided it (-1 for tests that don't have axes)
+	 * @return Whether or not they're touching
+	 */
+	static bool collide(PhysicsBody* a, PhysicsBody* b,
+		PhysicsContact& contact, int& axisIndex);
+
+	// the exact tests, boxes are oriented with their bodies
+	static bool sphereVsSphere(PhysicsBody* a, PhysicsBody* b,
+		PhysicsContact& contact, int& axisIndex);
+	static bool sphereVsBox(PhysicsBody* a, PhysicsBody* b,
+		PhysicsContact& contact, int& axisIndex);
+	static bool boxVsSphere(PhysicsBody* a, PhysicsBody* b,
+		PhysicsContact& contact, int& axisIndex);
+	// SAT with the 15 axes that can separate two boxes, 3 faces from each
+	// box and the 9 cross products of their edges
+	static bool boxVsBox(PhysicsBody* a, PhysicsBody* b,
+		PhysicsContact& contact, int& axisIndex);
+
+	// GJK and EPA on the colliders' support functions, used for anything
+	// round that isn't a sphere
+	static bool gjk(PhysicsBody* a, PhysicsBody* b,
+		PhysicsContact& contact, int& axisIndex);
+
+	// the generic SAT against every point and normal
+	static bool generic(PhysicsBody* a, PhysicsBody* b,
+		PhysicsContact& contact, int& axisIndex);
+
+private:
+	typedef bool(*CollideFunc)(PhysicsBody*, PhysicsBody*, PhysicsContact&,
+		int&);
+
+	// test to use for each pair of types, by a's type then b's
+	static CollideFunc m_table[COLLIDER_TYPE_COUNT][COLLIDER_TYPE_COUNT];
+};
@@ -6,6 +6,7 @@
 
 #include <cassert> // for assert()
 
+#include "physicsthread.h"
 #include "shapes.h"
 
 PhysicsActor::PhysicsActor(Vector3 pos)
@@ -13,6 +14,7 @@ PhysicsActor::PhysicsActor(Vector3 pos)
 {
 	m_type = ACTORTYPE_PHYSICS;
 	m_body = new PhysicsBody();
+	assert(m_body);
 	m_body->setPosition(pos);
 
 	// add our body to the physics world
@@ -24,29 +26,49 @@ PhysicsActor::~PhysicsActor()
 	delete m_body;
 }
 
-void PhysicsActor::update(float delta)
+void PhysicsActor::update(float /*delta*/)
 {
-	// make sure we have a body and that body has a collider
-	assert(m_body);
+	// nothing to do, the PhysicsManager steps the body and the World syncs
+	// it back, this is just here for anything deriving from us to call
+}
+
+void PhysicsActor::syncFromBody(float alpha)
+{
+	// the collider's given to the body after we're made, so this is the
+	// first place it can be checked
 	assert(m_body->getCollider());
 
 	if (m_body->isEnabled())
 	{
-		// update the body's physics
-		m_body->update(delta);
-
 		// apply the body's transform to our actor transform
-		m_localTransform = m_body->getTransformMatrix();
+		if (alpha >= 1.0f)
+			m_localTransform = m_body->getTransformMatrix();
+		else
+			m_localTransform =
+				m_body->getInterpolatedTransform(alpha).toMatrix();
 		updateTransform();
+		m_broadExtents = m_body->getBroadExtents();
+	}
+}
+
+void PhysicsActor::syncFromSnapshot(PhysicsSnapshot* snapshot, float alpha)
+{
+	// bodies that weren't in the snapshot stay where they were
+	Transform t;
+	if (snapshot->getTransform(m_body, alpha, t))
+	{
+		m_localTransform = t.toMatrix();
+		updateTransform();
+		snapshot->getBroadExtents(m_body, m_broadExtents);
 	}
 }
 
 void PhysicsActor::draw()
 {
 	// draw the broad bounding box by default
-	Vector3 extents = m_body->getBroadExtents();
-
-	drawBox(Vector3(), extents, Vector4(1, 1, 1, 1), &m_globalTransform);
+	// (the one from the last sync, the body might be mid-step)
+	drawBox(Vector3(), m_broadExtents, Vector4(1, 1, 1, 1),
+		&m_globalTransform);
 }
 
 void PhysicsActor::setEnabled(bool e)
@@ -7,6 +7,8 @@
 #include "actor.h"
 #include "physics.h"
 
+struct PhysicsSnapshot;
+
 class PhysicsActor : public Actor
 {
 public:
@@ -16,6 +18,18 @@ public:
 	virtual void update(float delta) override;
 	virtual void draw() override;
 
+	// copies the body's transform onto the actor
+	// the World does this for every physics actor once the physics has been
+	// stepped, the body itself is only ever stepped by the PhysicsManager
+	// alpha is how far between the body's last two steps to put the actor,
+	// for drawing in between steps
+	void syncFromBody(float alpha = 1.0f);
+	// same thing but from a snapshot published by the physics thread, for
+	// when the body itself is busy being stepped
+	// both also grab anything draw() needs from the body, so drawing never
+	// looks at the body while the physics thread could be changing it
+	void syncFromSnapshot(PhysicsSnapshot* snapshot, float alpha);
+
 	// enables/disabled the physics body as well as the actor itself
 	void setEnabled(bool e) override;
 
@@ -25,4 +39,6 @@ public:
 
 protected:
 	PhysicsBody* m_body;
+	// the body's broad extents as of the last sync, for drawing
+	Vector3 m_broadExtents;
 };
\ No newline at end of file
@@ -0,0 +1,406 @@
+/* =================================
+ *  Physics Bench
+ *  Steps physics scenes without a window so the physics can be profiled on
+ *  machines without a display
+ *
+ *  Usage:
+ *		physics_bench [scene] [bodies] [steps] [options]
+ *	Scenes are "pile" (boxes dropped onto a floor), "balls" (a ball pit),
+ *	"bullets" (small boxes fired down at a thin floor) and "level" (a few
+ *	boxes dropped onto lots of static ledges)
+ *	Options:
+ *		--broadphase octree|sap|bvh	which broadphase to step with
+ *		--threads n					how many threads to step with
+ *		--sat						use the generic SAT for every pair
+ *		--ccd						turn on continuous collision for every
+ *									body that moves
+ *		--hz n						how many steps make up a second
+ * ================================= */
+#include <cmath>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+
+#include <darray.h>
+#include <jobsystem.h>
+
+#include "benchallocator.h"
+#include "physics.h"
+#include "collideraabb.h"
+#include "collidersphere.h"
+#include "narrowphase.h"
+
+// same step the game uses
+#define BENCH_TIMESTEP 0.016f
+
+// whether bodies that move are made continuous
+static bool s_continuous = false;
+
+// random float between min and max
+// gmath's randBetween seeds itself randomly, this uses rand() so srand() can
+// make every run the same
+static float benchRand(float min, float max)
+{
+	return min + (max - min) * ((float)rand() / (float)RAND_MAX);
+}
+
+// makes a static box and adds it to the world
+static PhysicsBody* addStaticBox(DArray<PhysicsBody*>& bodies,
+	Vector3 const& pos, Vector3 const& extents)
+{
+	PhysicsBody* body = new PhysicsBody(new ColliderAABB(extents));
+	body->setPosition(pos);
+	body->setStatic(true);
+
+	PhysicsManager::getInstance()->addPhysicsBody(body);
+	bodies.add(body);
+	return body;
+}
+
+// a big floor with a bunch of random boxes falling onto it, like DemoState
+static void buildPile(DArray<PhysicsBody*>& bodies, int count)
+{
+	addStaticBox(bodies, Vector3(0, 0, 0), Vector3(100, 1, 100));
+
+	// spread the boxes out more when there's more of them
+	float spread = sqrtf((float)count) * 0.6f;
+	for (int i = 0; i < count; ++i)
+	{
+		Vector3 size(benchRand(0.1f, 0.8f), benchRand(0.1f, 0.8f),
+			benchRand(0.1f, 0.8f));
+		Vector3 pos(benchRand(-spread, spread), benchRand(1.1f, 5.8f),
+			benchRand(-spread, spread));
+
+		PhysicsBody* body = new PhysicsBody(new ColliderAABB(size));
+		body->setPosition(pos);
+		body->setMass(benchRand(0.1f, 2.0f));
+		body->setContinuous(s_continuous);
+
+		PhysicsManager::getInstance()->addPhysicsBody(body);
+		bodies.add(body);
+	}
+}
+
+// balls dropped into a walled-off pit
+static void buildBalls(DArray<PhysicsBody*>& bodies, int count)
+{
+	float half = sqrtf((float)count) * 0.5f + 1.0f;
+
+	// floor and four walls
+	addStaticBox(bodies, Vector3(0, 0, 0),
+		Vector3(half + 1.0f, 1.0f, half + 1.0f));
+	addStaticBox(bodies, Vector3(-half, 5.0f, 0.0f),
+		Vector3(0.5f, 5.0f, half));
+	addStaticBox(bodies, Vector3(half, 5.0f, 0.0f),
+		Vector3(0.5f, 5.0f, half));
+	addStaticBox(bodies, Vector3(0.0f, 5.0f, -half),
+		Vector3(half, 5.0f, 0.5f));
+	addStaticBox(bodies, Vector3(0.0f, 5.0f, half),
+		Vector3(half, 5.0f, 0.5f));
+
+	float inner = half - 1.0f;
+	for (int i = 0; i < count; ++i)
+	{
+		Vector3 pos(benchRand(-inner, inner), benchRand(2.0f, 12.0f),
+			benchRand(-inner, inner));
+
+		PhysicsBody* body = new PhysicsBody(
+			new ColliderSphere(Vector3(0, 0, 0), 0.5f));
+		body->setPosition(pos);
+		body->setContinuous(s_continuous);
+
+		PhysicsManager::getInstance()->addPhysicsBody(body);
+		bodies.add(body);
+	}
+}
+
+// small boxes fired down at a floor that's only a unit thick, fast enough to
+// go straight through it in one step without continuous collision
+static void buildBullets(DArray<PhysicsBody*>& bodies, int count)
+{
+	float spread = sqrtf((float)count) * 0.6f;
+	addStaticBox(bodies, Vector3(0, 0, 0),
+		Vector3(spread + 2.0f, 0.5f, spread + 2.0f));
+
+	for (int i = 0; i < count; ++i)
+	{
+		Vector3 size(benchRand(0.05f, 0.2f), benchRand(0.05f, 0.2f),
+			benchRand(0.05f, 0.2f));
+		Vector3 pos(benchRand(-spread, spread), benchRand(4.0f, 12.0f),
+			benchRand(-spread, spread));
+
+		PhysicsBody* body = new PhysicsBody(new ColliderAABB(size));
+		body->setPosition(pos);
+		body->setVelocity(Vector3(benchRand(-2.0f, 2.0f),
+			benchRand(-90.0f, -60.0f), benchRand(-2.0f, 2.0f)));
+		body->setContinuous(s_continuous);
+
+		PhysicsManager::getInstance()->addPhysicsBody(body);
+		bodies.add(body);
+	}
+}
+
+// lots of static ledges like a level would have, with a box dropped onto
+// every tenth one, so nearly everything in the world is standing still
+static void buildLevel(DArray<PhysicsBody*>& bodies, int count)
+{
+	addStaticBox(bodies, Vector3(0, 0, 0), Vector3(100, 1, 100));
+
+	int side = (int)ceilf(sqrtf((float)count));
+	for (int i = 0; i < count; ++i)
+	{
+		Vector3 pos(((i % side) - side * 0.5f) * 3.0f,
+			benchRand(2.0f, 6.0f), ((i / side) - side * 0.5f) * 3.0f);
+		addStaticBox(bodies, pos, Vector3(benchRand(0.5f, 1.2f), 0.25f,
+			benchRand(0.5f, 1.2f)));
+
+		if (i % 10 != 0)
+			continue;
+
+		PhysicsBody* body = new PhysicsBody(new ColliderAABB(
+			Vector3(0.3f, 0.3f, 0.3f)));
+		body->setPosition(pos + Vector3(0.0f, 3.0f, 0.0f));
+		body->setContinuous(s_continuous);
+
+		PhysicsManager::getInstance()->addPhysicsBody(body);
+		bodies.add(body);
+	}
+}
+
+// counts the bodies that have ended up underneath the floor
+static int countTunnelled(DArray<PhysicsBody*>& bodies)
+{
+	int count = 0;
+	for (int i = 0; i < bodies.getCount(); ++i)
+		if (!bodies[i]->isStatic() && bodies[i]->getPosition().y < 0.0f)
+			count++;
+	return count;
+}
+
+// adds up every body's position so runs can be checked against each other
+static double positionChecksum(DArray<PhysicsBody*>& bodies)
+{
+	double sum = 0.0;
+	for (int i = 0; i < bodies.getCount(); ++i)
+	{
+		Vector3 p = bodies[i]->getPosition();
+		sum += (double)p.x + (double)p.y + (double)p.z;
+	}
+	return sum;
+}
+
+// runs the narrowphase on every pair of bodies that might be touching and
+// counts how many heap allocations that made, which should be none once the
+// scratch memory has grown big enough
+static void countNarrowphaseAllocations(DArray<PhysicsBody*>& bodies)
+{
+	PhysicsManager* physics = PhysicsManager::getInstance();
+
+	// find the pairs first, the broadphase query is allowed to allocate
+	DArray<PhysicsBody*> checkers;
+	DArray<PhysicsBody*> others;
+	for (int i = 0; i < bodies.getCount(); ++i)
+	{
+		PhysicsBody* a = bodies[i];
+		if (!a->checksCollision())
+			continue;
+
+		Vector3 pos = a->getPosition();
+		Vector3 extents = a->getBroadExtents();
+		DArray<PhysicsBody*> inRange =
+			physics->getBodiesInRange(pos - extents, pos + extents);
+		for (int j = 0; j < inRange.getCount(); ++j)
+		{
+			PhysicsBody* b = inRange[j];
+			// each pair once, checked by a body that checks collisions
+			if (b == a ||
+				(b->checksCollision() && b->getId() < a->getId()))
+				continue;
+			checkers.add(a);
+			others.add(b);
+		}
+	}
+
+	// first time around is allowed to grow the scratch memory
+	long long allocations = 0;
+	for (int pass = 0; pass < 2; ++pass)
+	{
+		long long before = getAllocationCount();
+		for (int i = 0; i < checkers.getCount(); ++i)
+		{
+			PhysicsContact contact;
+			int axis = -1;
+			checkers[i]->findContact(others[i], contact, axis);
+		}
+		allocations = getAllocationCount() - before;
+	}
+
+	printf("narrowphase allocations: %lld over %i pairs\n", allocations,
+		checkers.getCount());
+}
+
+// fills the octree back up from scratch and counts how many heap allocations
+// that made, which should be none once it's been filled once before since
+// it reuses its trees and objects
+static void countTreeAllocations(DArray<PhysicsBody*>& bodies)
+{
+	Octree<PhysicsBody*>* tree = PhysicsManager::getInstance()->getTree();
+
+	// first time around is allowed to grow the pools
+	long long allocations = 0;
+	for (int pass = 0; pass < 2; ++pass)
+	{
+		long long before = getAllocationCount();
+		tree->clear();
+		for (int i = 0; i < bodies.getCount(); ++i)
+			if (bodies[i]->isEnabled())
+				tree->insert(bodies[i], bodies[i]->getBroadCube());
+		allocations = getAllocationCount() - before;
+	}
+
+	printf("octree rebuild allocations: %lld over %i bodies\n", allocations,
+		bodies.getCount());
+}
+
+int main(int argc, char** argv)
+{
+	const char* scene = "pile";
+	int count = 500;
+	int steps = 300;
+	BroadphaseMode broadphase = BROADPHASE_SAP;
+	int threads = 1;
+	float timestep = BENCH_TIMESTEP;
+
+	// grab options first, everything else is positional
+	int positional = 0;
+	for (int i = 1; i < argc; ++i)
+	{
+		if (strcmp(argv[i], "--broadphase") == 0 && i + 1 < argc)
+		{
+			const char* mode = argv[++i];
+			if (strcmp(mode, "octree") == 0)
+				broadphase = BROADPHASE_OCTREE;
+			else if (strcmp(mode, "sap") == 0)
+				broadphase = BROADPHASE_SAP;
+			else if (strcmp(mode, "bvh") == 0)
+				broadphase = BROADPHASE_BVH;
+			else
+			{
+				printf("unknown broadphase '%s', try octree, sap or bvh\n", mode);
+				return 1;
+			}
+			continue;
+		}
+		if (strcmp(argv[i], "--threads") == 0 && i + 1 < argc)
+		{
+			threads = atoi(argv[++i]);
+			if (threads < 1)
+				threads = 1;
+			continue;
+		}
+		if (strcmp(argv[i], "--sat") == 0)
+		{
+			Narrowphase::forceSAT = true;
+			continue;
+		}
+		if (strcmp(argv[i], "--ccd") == 0)
+		{
+			s_continuous = true;
+			continue;
+		}
+		if (strcmp(argv[i], "--hz") == 0 && i + 1 < argc)
+		{
+			float hz = (float)atof(argv[++i]);
+			if (hz > 0.0f)
+				timestep = 1.0f / hz;
+			continue;
+		}
+
+		switch (positional++)
+		{
+		case 0: scene = argv[i]; break;
+		case 1: count = atoi(argv[i]); break;
+		case 2: steps = atoi(argv[i]); break;
+		}
+	}
+
+	// same seed every run so runs can be compared
+	srand(1);
+
+	PhysicsManager::create();
+	PhysicsManager::gravity = 18.0f;
+
+	DArray<PhysicsBody*> bodies;
+	if (strcmp(scene, "pile") == 0)
+		buildPile(bodies, count);
+	else if (strcmp(scene, "balls") == 0)
+		buildBalls(bodies, count);
+	else if (strcmp(scene, "bullets") == 0)
+		buildBullets(bodies, count);
+	else if (strcmp(scene, "level") == 0)
+		buildLevel(bodies, count);
+	else
+	{
+		printf("unknown scene '%s', try pile, balls, bullets or level\n",
+			scene);
+		PhysicsManager::destroy();
+		return 1;
+	}
+
+	PhysicsManager* physics = PhysicsManager::getInstance();
+	physics->setBroadphase(broadphase);
+
+	// this thread is one of them, so only make the rest
+	JobSystem* jobs = nullptr;
+	if (threads > 1)
+	{
+		jobs = new JobSystem(threads - 1);
+		physics->setJobSystem(jobs);
+	}
+
+	// add up how long each stage took over every step
+	double stageMs[STAGE_COUNT] = {};
+	// and how often the SAT axis cache was right
+	long long axisHits = 0;
+	long long axisMisses = 0;
+
+	auto start = std::chrono::high_resolution_clock::now();
+	for (int i = 0; i < steps; ++i)
+	{
+		physics->update(timestep);
+		for (int j = 0; j < STAGE_COUNT; ++j)
+			stageMs[j] += physics->getStageTime((PhysicsStage)j);
+		axisHits += physics->getAxisCacheHits();
+		axisMisses += physics->getAxisCacheMisses();
+	}
+	auto end = std::chrono::high_resolution_clock::now();
+
+	double totalMs =
+		std::chrono::duration<double, std::milli>(end - start).count();
+
+	printf("scene: %s, bodies: %i, steps: %i, threads: %i\n", scene,
+		bodies.getCount(), steps, threads);
+	printf("total: %.3fms, per step: %.3fms\n", totalMs, totalMs / steps);
+	for (int i = 0; i < STAGE_COUNT; ++i)
+		printf("  %-12s %.3fms\n",
+			PhysicsManager::getStageName((PhysicsStage)i), stageMs[i] / steps);
+	long long axisTests = axisHits + axisMisses;
+	printf("axis cache: %.1f%% of %lld SAT tests\n",
+		axisTests > 0 ? 100.0 * axisHits / axisTests : 0.0, axisTests);
+	printf("checksum: %.6f\n", positionChecksum(bodies));
+	if (strcmp(scene, "bullets") == 0)
+		printf("tunnelled through the floor: %i\n", countTunnelled(bodies));
+	countNarrowphaseAllocations(bodies);
+	if (broadphase == BROADPHASE_OCTREE)
+		countTreeAllocations(bodies);
+
+	physics->clear();
+	for (int i = 0; i < bodies.getCount(); ++i)
+		delete bodies[i];
+
+	PhysicsManager::destroy();
+	delete jobs;
+
+	return 0;
+}
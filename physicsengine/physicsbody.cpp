@@ -1,143 +1,112 @@
 #include "physicsbody.h"
 
+#include <cmath>
+#include <cstdio>
 #include <cassert>
+#include <arena.h>
 #include <darray.h>
-#include <Gizmos.h>
 
-#include "util.h"
-#include "shapes.h"
+#include "ccd.h"
 #include "collider.h"
 #include "collideraabb.h"
 #include "collidersphere.h"
+#include "narrowphase.h"
+#include "physicsdebug.h"
 #include "physicsmanager.h"
 
 PhysicsBody::PhysicsBody(Collider* collider)
 	: m_collider(collider)
 {
+	// grab a slot for our data, it starts with default values
+	m_store = PhysicsManager::getInstance()->getBodyStore();
+	m_index = m_store->add(this);
+
 	if (collider)
+	{
 		collider->body = this;
+		setFlag(BODY_HAS_COLLIDER, true);
+	}
 
 	m_collideCallback = nullptr;
-
-	// default velocities
-	m_velocity = Vector3(0, 0, 0);
-	m_angularVelocity = Vector3(0, 0, 0);
+	m_id = -1;
 
 	// default values
-	m_zone = false;
 	m_debug = false;
-	m_asleep = false;
-	m_static = false;
-	m_enabled = true;
-	m_useGravity = true;
-	m_gravityStrength = 1.0f;
+	m_swept = false;
 
 	// sleeping values
 	m_stillTime = 0.0f;
 	m_stillPos = Vector3();
+	m_sleepIsland = -1;
 
 	// physical values
-	m_drag = 0.0f;
-	m_angularDrag = 1.0f;
-	m_mass = 1.0f;
 	m_bounce = 0.0f;
 	m_momentOfInertia = 1.0f;
 
 	m_friction = 0.05f;
     m_frictionMode = FRICTION_AVG;
+
+	updateBroadExtents();
+	setFlag(BODY_SHAPE_DIRTY, true);
 }
 
 PhysicsBody::~PhysicsBody()
 {
 	delete m_collider;
+
+	// the manager (and its store) might have already been destroyed
+	if (PhysicsManager::getInstance())
+	{
+		// anything that was resting on this needs to notice it's gone
+		wakeUp();
+		m_store->remove(m_index);
+	}
 }
 
-void PhysicsBody::update(float delta)
+void PhysicsBody::updateSleep(float delta)
 {
-	if (!m_enabled)
-		return;
-	if (!m_collider)
+	if (!isEnabled() || !m_collider || isAsleep() || isStatic())
 		return;
 
-	// sleeping bodies don't check their own collision
-	// instead, other bodies check if they collided with sleeping bodies
-	// and wake them up if so
-	if (m_asleep)
-		return;
-
-	if (!m_static)
+	// check for sleeping
+	// by checking how much it's moved
+	Vector3 pos = getPosition();
+	Vector3 dif = m_stillPos - pos;
+	if (dif.magnitudeSquared() < 0.1f &&
+		getVelocity().magnitudeSquared() < 0.1f &&
+		getAngularVelocity().magnitudeSquared() < 0.1f)
 	{
-		// apply gravity
-		if (m_useGravity)
-			m_velocity.y -= m_gravityStrength * PhysicsManager::gravity * delta;
-
-		// drags
-		m_velocity -= (m_velocity * m_drag) * delta;
-		m_angularVelocity -= (m_angularVelocity * m_angularDrag) * delta;
-
-		// apply minimum velocity thresholds
-		if (m_velocity.magnitudeSquared() <
-			MIN_LINEAR_THRESHOLD*MIN_LINEAR_THRESHOLD)
-			m_velocity.set(0, 0, 0);
-		if (m_angularVelocity.magnitudeSquared() <
-			MIN_ROTATIONAL_THRESHOLD*MIN_ROTATIONAL_THRESHOLD)
-			m_angularVelocity.set(0, 0, 0);
-
-		// apply velocities
-		Vector3 position = m_transform.getPosition();
-		Vector3 newPos = position + (m_velocity * delta);
-		m_transform.setPosition(newPos);
-
-		Vector3 av = m_angularVelocity * delta;
-		this->rotate(av);
-
-		// check for sleeping
-		// by checking how much it's moved
-		Vector3 dif = m_stillPos - newPos;
-		if (dif.magnitudeSquared() < 0.1f &&
-			m_velocity.magnitudeSquared() < 0.1f &&
-			m_angularVelocity.magnitudeSquared() < 0.1f)
-		{
-			// body hasn't moved much, keep a timer on that
-			m_stillTime += delta;
-			// if we haven't moved for a long time, it's safe to put this
-			// body to sleep!
-			if (m_stillTime >= 3.0f)
-				m_asleep = true;
-		}
-		else
-		{
-			// body moved enough to keep it awake
-			// reset our timer
-			m_stillTime = 0.0f;
-			// and update our last position
-			m_stillPos = newPos;
-			m_asleep = false;
-		}
+		// body hasn't moved much, keep a timer on that
+		// it only actually sleeps once everything it's touching is still too
+		m_stillTime += delta;
+	}
+	else
+	{
+		// body moved enough to keep it awake
+		// reset our timer
+		m_stillTime = 0.0f;
+		// and update our last position
+		m_stillPos = pos;
 	}
+}
 
-	updateBroadExtents();
+void PhysicsBody::drawDebug()
+{
+	if (!isEnabled() || !m_collider)
+		return;
 
 	// draw debug information if needed
-	if (m_debug)
+	PhysicsDebugDraw* debugDraw = getDebugDraw();
+	if (debugDraw)
 	{
 		// draw collider information
-		m_collider->drawPoints();
-		m_collider->drawNormals();
+		m_collider->drawPoints(debugDraw);
+		m_collider->drawNormals(debugDraw);
 
 		// draw its broad phase collision box
-		aie::Gizmos::addAABB(toVec3(m_transform.getPosition()),
-			toVec3(getBroadExtents()), glm::vec4(1, 0, 0, 1));
+		debugDraw->drawBox(getPosition(), getBroadExtents(),
+			Vector4(1, 0, 0, 1));
 	}
-
-	// static objects don't need to check their collision, as dynamic objects
-	// check their collision against static objects
-	// BUT zones should check regardless, since they need to keep track of
-	// bodies inside them
-	if (m_static && !m_zone)
-		return;
-
-	checkCollision();
 }
 
 void PhysicsBody::setCollider(Collider* c)
@@ -145,54 +114,85 @@ void PhysicsBody::setCollider(Collider* c)
 	m_collider = c;
 	// make sure the collider knows we own it too
 	c->body = this;
+	setFlag(BODY_HAS_COLLIDER, true);
+	setFlag(BODY_SHAPE_DIRTY, true);
+	updateBroadExtents();
 }
 
 void PhysicsBody::setTransform(Matrix4 const& m)
 {
-	m_transform = m;
+	// the store keeps position and rotation separately
+	Matrix4 copy = m;
+	setTransform(Transform(copy.getPosition(), Quaternion::fromMatrix(m)));
 }
 
-void PhysicsBody::setPosition(Vector3 const& v)
+void PhysicsBody::setTransform(Transform const& t)
 {
-	m_transform.setPosition(v);
+	moveTo(t.position);
+	m_store->orientations[m_index] = t.rotation;
+	setFlag(BODY_SHAPE_DIRTY, true);
 	updateBroadExtents();
+	resetInterpolation();
 }
 
-void PhysicsBody::setRotation(Vector3 const& v)
+void PhysicsBody::setPosition(Vector3 const& v)
 {
-	Matrix4 xRot, yRot, zRot;
-	xRot.setRotateX(v.x);
-	yRot.setRotateY(v.y);
-	zRot.setRotateZ(v.z);
+	moveTo(v);
 
-	Matrix4 rotationMatrix = xRot * yRot * zRot;
-	rotationMatrix.setPosition(m_transform.getPosition());
+	// it's been here since before the last step as far as drawing goes
+	m_store->prevX[m_index] = v.x;
+	m_store->prevY[m_index] = v.y;
+	m_store->prevZ[m_index] = v.z;
+}
 
-	m_transform = rotationMatrix;
-	updateBroadExtents();
+void PhysicsBody::moveTo(Vector3 const& v)
+{
+	// the broad extents are only a size, so moving doesn't change them
+	m_store->posX[m_index] = v.x;
+	m_store->posY[m_index] = v.y;
+	m_store->posZ[m_index] = v.z;
+	setFlag(BODY_SHAPE_DIRTY, true);
+	setFlag(BODY_BROAD_MOVED, true);
 }
 
-void PhysicsBody::rotate(Vector3 const& v)
+void PhysicsBody::setMass(float m)
 {
-	// make rotation matrix
-	Matrix4 xRot, yRot, zRot;
-	xRot.setRotateX(v.x);
-	yRot.setRotateY(v.y);
-	zRot.setRotateZ(v.z);
+	m_store->mass[m_index] = m;
+	m_store->invMass[m_index] = isStatic() ? 0.0f : 1.0f / m;
+}
 
-	Matrix4 rotationMatrix = zRot * yRot * xRot;
+void PhysicsBody::setStatic(bool s)
+{
+	setFlag(BODY_STATIC, s);
+	// static bodies act like they have infinite mass
+	float m = getMass();
+	m_store->invMass[m_index] = s ? 0.0f : 1.0f / m;
+}
 
-	m_transform = m_transform * rotationMatrix;
+void PhysicsBody::setRotation(Vector3 const& v)
+{
+	m_store->orientations[m_index] = Quaternion::fromEuler(v);
+	setFlag(BODY_SHAPE_DIRTY, true);
+	updateBroadExtents();
+}
+
+void PhysicsBody::rotate(Vector3 const& v)
+{
+	// turning by v for 1 second is the same as turning by v
+	m_store->orientations[m_index].integrate(v, 1.0f);
+	setFlag(BODY_SHAPE_DIRTY, true);
+	updateBroadExtents();
 }
 
 Vector3 PhysicsBody::getPosition()
 {
-	return m_transform.getPosition();
+	return Vector3(m_store->posX[m_index], m_store->posY[m_index],
+		m_store->posZ[m_index]);
 }
 
 void PhysicsBody::addForce(Vector3 force, Vector3 pos)
 {
-	m_velocity += force;
+	setVelocity(getVelocity() + force);
 
     // abandon all hope for rotation
 
@@ -201,54 +201,134 @@ void PhysicsBody::addForce(Vector3 force, Vector3 pos)
     
 	//if (deltaAng.magnitudeSquared() > 0.001f)
 	//	m_angularVelocity -= deltaAng;
-	if (m_debug && pos.magnitudeSquared() > 0.0f)
+	PhysicsDebugDraw* debugDraw = getDebugDraw();
+	if (debugDraw && pos.magnitudeSquared() > 0.0f)
 	{
 		Vector3 p = pos + getPosition();
-		aie::Gizmos::addLine(toVec3(p),
-			toVec3(p + force.normalised() * 5.0f),
-			glm::vec4(0, 1, 0, 1));
-		drawSphere(p, 0.2f, Vector4(0, 1, 0, 1));
+		debugDraw->drawLine(p, p + force.normalised() * 5.0f,
+			Vector4(0, 1, 0, 1));
+		debugDraw->drawSphere(p, 0.2f, Vector4(0, 1, 0, 1));
 	}
 }
 
 Vector3 PhysicsBody::transformPoint(Vector3 const& pt)
 {
-	// make a position matrix using this point
-	Matrix4 pointMatrix;
-	pointMatrix.setPosition(pt);
+	Vector3 result = m_store->orientations[m_index].rotate(pt);
+	result += getPosition();
+	return result;
+}
+
+Vector3* PhysicsBody::getWorldPoints()
+{
+	if (hasFlag(BODY_SHAPE_DIRTY))
+		updateWorldShape();
+	return m_worldPoints._getArray();
+}
+
+Vector3* PhysicsBody::getWorldNormals()
+{
+	if (hasFlag(BODY_SHAPE_DIRTY))
+		updateWorldShape();
+	return m_worldNormals._getArray();
+}
+
+void PhysicsBody::updateWorldShape()
+{
+	setFlag(BODY_SHAPE_DIRTY, false);
+	if (!m_collider)
+		return;
+
+	// the collider's shape might have changed size
+	int pointCount = m_collider->points.getCount();
+	int normalCount = m_collider->normals.getCount();
+	if (m_worldPoints.getCount() != pointCount)
+	{
+		m_worldPoints.clear();
+		for (int i = 0; i < pointCount; ++i)
+			m_worldPoints.add(Vector3());
+	}
+	if (m_worldNormals.getCount() != normalCount)
+	{
+		m_worldNormals.clear();
+		for (int i = 0; i < normalCount; ++i)
+			m_worldNormals.add(Vector3());
+	}
+
+	// one transform for every point, normals only turn
+	// with this many points it's quicker to make a matrix first
+	Matrix4 transform = getTransformMatrix();
+	Matrix4::transformPoints(transform, m_collider->points._getArray(),
+		m_worldPoints._getArray(), pointCount);
+	Matrix4::rotatePoints(transform, m_collider->normals._getArray(),
+		m_worldNormals._getArray(), normalCount);
+}
+
+Vector3 PhysicsBody::inverseTransformPoint(Vector3 const& pt)
+{
+	return inverseRotatePoint(getPosition() * -1.0f + pt);
+}
+
+Vector3 PhysicsBody::inverseRotatePoint(Vector3 const& pt)
+{
+	return m_store->orientations[m_index].inverseRotate(pt);
+}
 
-	// transform it with our current transform
-	Matrix4 resultMatrix = getTransformMatrix() * pointMatrix;
+void PhysicsBody::projectCollider(Vector3 const& axis, float& min, float& max)
+{
+	// a transformed point dotted with the axis is the same as the point
+	// dotted with the axis turned into our space, plus where we are
+	Vector3 localAxis = inverseRotatePoint(axis);
+	float offset = getPosition().dot(axis);
 
-	// we just want the position, not the whole matrix
-	return resultMatrix.getPosition();
+	min = INFINITY;
+	max = -INFINITY;
+	for (int i = 0; i < m_collider->points.getCount(); ++i)
+	{
+		float dot = localAxis.dot(m_collider->points[i]) + offset;
+		if (dot < min)
+			min = dot;
+		if (dot > max)
+			max = dot;
+	}
 }
 
 Vector3 PhysicsBody::rotatePoint(Vector3 const & pt)
 {
-	// make a position matrix using this point
-	Matrix4 pointMatrix;
-	pointMatrix.setPosition(pt);
+	// transform it with JUST our rotation
+	return m_store->orientations[m_index].rotate(pt);
+}
+
+Transform PhysicsBody::getTransform()
+{
+	return Transform(getPosition(), m_store->orientations[m_index]);
+}
 
-	// transform it with JUST our rotation matrix
-	Matrix4 resultMatrix = getRotationMatrix() * pointMatrix;
+Transform PhysicsBody::getInterpolatedTransform(float alpha)
+{
+	Vector3 previous(m_store->prevX[m_index], m_store->prevY[m_index],
+		m_store->prevZ[m_index]);
+	return Transform(Vector3::lerpBetween(previous, getPosition(), alpha),
+		Quaternion::lerpBetween(m_store->prevOrientations[m_index],
+			m_store->orientations[m_index], alpha));
+}
 
-	// we just want the resulting position
-	return resultMatrix.getPosition();
+void PhysicsBody::resetInterpolation()
+{
+	m_store->prevX[m_index] = m_store->posX[m_index];
+	m_store->prevY[m_index] = m_store->posY[m_index];
+	m_store->prevZ[m_index] = m_store->posZ[m_index];
+	m_store->prevOrientations[m_index] = m_store->orientations[m_index];
 }
 
+// puts the position back onto the rotation to make the whole transform
 Matrix4 PhysicsBody::getTransformMatrix()
 {
-	return m_transform;
+	return getTransform().toMatrix();
 }
 
-// gets just the rotation matrix by setting the transform matrix's position
-// to 0,0,0
 Matrix4 PhysicsBody::getRotationMatrix()
 {
-	Matrix4 temp = m_transform;
-	temp.setPosition(Vector3());
-	return temp;
+	return m_store->orientations[m_index].toMatrix();
 }
 
 bool PhysicsBody::AABBvsAABB(Collider* c1, Collider* c2)
@@ -260,13 +340,22 @@ bool PhysicsBody::AABBvsAABB(Collider* c1, Collider* c2)
 	ColliderAABB* a1 = (ColliderAABB*)c1;
 	ColliderAABB* a2 = (ColliderAABB*)c2;
 
-	// get the minimum/maximum point of c1/a1
-	Vector3 min1 = a1->body->getPosition() - a1->extents;
-	Vector3 max1 = a1->body->getPosition() + a1->extents;
+	return AABBvsAABB(a1->body->getPosition(), a1->extents,
+		a2->body->getPosition(), a2->extents);
+}
+
+bool PhysicsBody::AABBvsAABB(Vector3 const& pos1, Vector3 const& ext1,
+	Vector3 const& pos2, Vector3 const& ext2)
+{
+	// get the minimum/maximum point of the first box
+	Vector3 p1 = pos1;
+	Vector3 min1 = p1 - ext1;
+	Vector3 max1 = p1 + ext1;
 
-	// get the minimum/maximum point of c2/a2
-	Vector3 min2 = a2->body->getPosition() - a2->extents;
-	Vector3 max2 = a2->body->getPosition() + a2->extents;
+	// get the minimum/maximum point of the second box
+	Vector3 p2 = pos2;
+	Vector3 min2 = p2 - ext2;
+	Vector3 max2 = p2 + ext2;
 
 	// check if any part of them is NOT colliding
 	if (min1 > max2 || max1 < min2 ||
@@ -289,18 +378,24 @@ bool PhysicsBody::AABBvsSphere(Collider* _aabb, Collider* _sphere)
 	// double check aabb is actually an aabb
 	assert(aabb->type == COLLIDER_AABB);
 
-	// grab their associated bodies so we can get their position more easily
-	PhysicsBody* sphereBody = sphere->body;
-	PhysicsBody* aabbBody = aabb->body;
-
 	// grab the actual center of the sphere collider
 	// (its attached object's position + its center offset)
-	Vector3 sphereCenter = sphereBody->getPosition() + sphere->center;
+	Vector3 sphereCenter = sphere->body->getPosition() + sphere->center;
+
+	return AABBvsSphere(aabb->body->getPosition(), aabb->extents,
+		sphereCenter, sphere->radius);
+}
+
+bool PhysicsBody::AABBvsSphere(Vector3 const& pos, Vector3 const& extents,
+	Vector3 const& center, float radius)
+{
+	Vector3 aabbPos = pos;
+	Vector3 sphereCenter = center;
 
 	// grab the minimum extents
-	Vector3 aabbMin = aabbBody->getPosition() - aabb->extents;
+	Vector3 aabbMin = aabbPos - extents;
 	// and the maximum extents
-	Vector3 aabbMax = aabbBody->getPosition() + aabb->extents;
+	Vector3 aabbMax = aabbPos + extents;
 
 	// clamp the center of the sphere to the box, making it so this new point
 	// will be within the radius of the sphere if they're colliding
@@ -311,7 +406,7 @@ bool PhysicsBody::AABBvsSphere(Collider* _aabb, Collider* _sphere)
 	float distSquared = (clampedCenter - sphereCenter).magnitudeSquared();
 
 	// test that against the squared radius of the sphere
-	return distSquared <= sphere->radius*sphere->radius;
+	return distSquared <= radius*radius;
 }
 
 bool PhysicsBody::SpherevsSphere(Collider* c1, Collider* c2)
@@ -335,59 +430,51 @@ bool PhysicsBody::SpherevsSphere(Collider* c1, Collider* c2)
 	return center1.distanceToSquared(center2) <= rad * rad;
 }
 
-// makes the broad phase collision box by checking each point of the collider
-// and keeping track of the lowest and highest points on each axis
+// makes the broad phase collision box by fitting a box around the
+// collider's own box after it's been rotated
+// each rotated axis of the collider's box reaches along a world axis by its
+// extent times how much it points that way, so adding those up is as far as
+// the box reaches - the same amount of work however many points there are
 void PhysicsBody::updateBroadExtents()
 {
 	// we don't want to update our broad box if we have no collider
 	if (!m_collider)
 		return;
 
-	// update our broad bounding box
-	Vector3 min(INFINITY, INFINITY, INFINITY);
-	Vector3 max(-INFINITY, -INFINITY, -INFINITY);
-	// go through all points and get the min/max positions
-	for (int i = 0; i < m_collider->points.getCount(); ++i)
+	Matrix4 r = getRotationMatrix();
+	Vector3 ext = m_collider->boundsExtents;
+	// the broad box stays around the body's position, so a collider that
+	// isn't centered on the body just makes it that much bigger
+	Vector3 offset = m_store->orientations[m_index].rotate(
+		m_collider->boundsCenter);
+
+	for (int i = 0; i < 3; ++i)
 	{
-		Vector3 p = transformPoint(m_collider->points[i]);
-
-		// check if any coordinate is smaller
-		if (p.x < min.x)
-			min.x = p.x;
-		if (p.y < min.y)
-			min.y = p.y;
-		if (p.z < min.z)
-			min.z = p.z;
-
-		// and check if any is larger
-		if (p.x > max.x)
-			max.x = p.x;
-		if (p.y > max.y)
-			max.y = p.y;
-		if (p.z > max.z)
-			max.z = p.z;
+		// m2d is column then row, so [j][i] is how much local axis j
+		// points along world axis i
+		m_broadExtents[i] = fabsf(r.m2d[0][i]) * ext.x +
+			fabsf(r.m2d[1][i]) * ext.y +
+			fabsf(r.m2d[2][i]) * ext.z +
+			fabsf(offset[i]);
 	}
-
-	// get the difference between these vectors,
-	// half of that will be the extents of an AABB collider
-	m_broadExtents = (max - min)*0.5f;
+	setFlag(BODY_BROAD_MOVED, true);
 }
 
-// wakes up the body so it starts checking collisions again
-void PhysicsBody::wakeUp()
+// gets the manager's debug drawer if this body wants debug information drawn
+// returns nullptr if it shouldn't be drawn (or there's nothing to draw with)
+PhysicsDebugDraw* PhysicsBody::getDebugDraw()
 {
-	if (!m_asleep)
-		return;
-	m_asleep = false;
-	m_stillTime = 0.0f;
-	m_stillPos = getPosition();
+	if (!m_debug)
+		return nullptr;
+	return PhysicsManager::getInstance()->getDebugDraw();
 }
 
-void PhysicsBody::checkCollision()
+// turns the body's broad phase extents into a box around its position
+OctCube PhysicsBody::getBroadCube()
 {
-	// turn our body's broad phase extents into a cube that the Octree can use
 	Vector3 pos = getPosition();
 	Vector3 extents = getBroadExtents();
+
 	OctCube cube;
 	cube.minX = pos.x - extents.x;
 	cube.minY = pos.y - extents.y;
@@ -397,68 +484,150 @@ void PhysicsBody::checkCollision()
 	cube.maxY = pos.y + extents.y;
 	cube.maxZ = pos.z + extents.z;
 
-	// grab a reference to all the bodies in range
-	PhysicsManager* p = PhysicsManager::getInstance();
-	DArray<PhysicsBody*> bodies = p->getTree()->getInRange(cube);
-
-	m_colliding.clear();
+	// a body being swept could have hit anything between where it started
+	// the step and where it is now
+	if (m_swept)
+	{
+		Vector3 start = pos - m_sweep;
+		cube.minX = fminf(cube.minX, start.x - extents.x);
+		cube.minY = fminf(cube.minY, start.y - extents.y);
+		cube.minZ = fminf(cube.minZ, start.z - extents.z);
+
+		cube.maxX = fmaxf(cube.maxX, start.x + extents.x);
+		cube.maxY = fmaxf(cube.maxY, start.y + extents.y);
+		cube.maxZ = fmaxf(cube.maxZ, start.z + extents.z);
+	}
+	return cube;
+}
 
-	for (int i = 0; i < bodies.getCount(); ++i)
+void PhysicsBody::updateSweep(float delta)
+{
+	m_swept = isContinuous() && checksCollision() && !isZone() &&
+		CCD::isFast(this, delta);
+	if (m_swept)
 	{
-		PhysicsBody* body = bodies[i];
+		m_sweep = getVelocity();
+		m_sweep *= delta;
+	}
+}
 
-		// there shouldn't be null bodies in here
-		assert(body);
+void PhysicsBody::sleep(int island)
+{
+	setFlag(BODY_ASLEEP, true);
+	m_sleepIsland = island;
+}
 
-		// make sure we're not colliding with ourself
-		if (body == this)
-			continue;
-		if (!body->isEnabled())
-			continue;
+// wakes up the body so it starts checking collisions again
+void PhysicsBody::wakeUp()
+{
+	if (!isAsleep())
+		return;
 
-		// get the other body's collider
-		Collider* col = body->getCollider();
+	// the island went to sleep together, so it wakes up together
+	// waking the island calls this again for each body once it's left it
+	if (m_sleepIsland >= 0)
+	{
+		PhysicsManager::getInstance()->wakeIsland(m_sleepIsland);
+		return;
+	}
 
-		// do broad phase check
-		if (!isCollidingBroad(col))
-			continue;
+	setFlag(BODY_ASLEEP, false);
+	m_stillTime = 0.0f;
+	m_stillPos = getPosition();
+}
 
-		// broad phase collision said we're colliding!
+bool PhysicsBody::isResting()
+{
+	return isAsleep() || (isStatic() && !isZone());
+}
 
-		// grab the actual collider of the other object
-		Collider* acol = body->getCollider();
+bool PhysicsBody::checksCollision()
+{
+	if (!isEnabled() || !m_collider)
+		return false;
 
-		// perform SAT collision and resolve it if it happened
-		Vector3 axis;
-		Vector3 point;
-		float penetration;
-		if (isCollidingSAT(acol, penetration, axis, point))
-		{
-			if (!m_zone && !body->isZone())
-				resolveCollision(acol, penetration, axis, point);
-			if (m_collideCallback)
-				m_collideCallback(body);
+	// sleeping bodies don't check their own collision
+	// instead, other bodies check if they collided with sleeping bodies
+	// and wake them up if so
+	if (isAsleep())
+		return false;
+
+	// static objects don't need to check their collision, as dynamic objects
+	// check their collision against static objects
+	// BUT zones should check regardless, since they need to keep track of
+	// bodies inside them
+	return !isStatic() || isZone();
+}
 
-			m_colliding.add(body);
+bool PhysicsBody::findContact(PhysicsBody* body, PhysicsContact& contact,
+	int& axis)
+{
+	// there shouldn't be null bodies in here
+	assert(body);
 
-			if (m_debug)
-				drawSphere(point, 0.05f, Vector4(1, 0, 0, 1));
-		}
+	// make sure we're not colliding with ourself
+	if (body == this || !body->isEnabled())
+	{
+		axis = -1;
+		return false;
 	}
+
+	// the broadphase only pairs up bodies whose broad boxes overlap, so go
+	// straight to the best test there is for these colliders
+	if (!Narrowphase::collide(this, body, contact, axis))
+		return false;
+
+	contact.a = this;
+	contact.b = body;
+	contact.manifold = nullptr;
+
+	// pack the ids together with the lower one first
+	int low = m_id < body->m_id ? m_id : body->m_id;
+	int high = m_id < body->m_id ? body->m_id : m_id;
+	contact.key = ((unsigned long long)low << 32) | (unsigned int)high;
+	return true;
+}
+
+void PhysicsBody::solveContact(PhysicsContact const& contact)
+{
+	PhysicsBody* body = contact.b;
+
+	if (!isZone() && !body->isZone())
+		resolveCollision(body->getCollider(), contact.penetration,
+			contact.axis, contact.point);
+}
+
+void PhysicsBody::reportContact(PhysicsContact const& contact)
+{
+	PhysicsBody* body = contact.b;
+
+	// both bodies get told about it, since this pair won't be checked again
+	// from the other side
+	if (m_collideCallback)
+		m_collideCallback(body);
+	if (body->m_collideCallback)
+		body->m_collideCallback(this);
+
+	m_colliding.add(body);
+	body->m_colliding.add(this);
+
+	PhysicsDebugDraw* debugDraw = getDebugDraw();
+	if (debugDraw)
+		debugDraw->drawSphere(contact.point, 0.05f, Vector4(1, 0, 0, 1));
 }
 
 void PhysicsBody::resolveCollision(Collider* other, float pen, Vector3 axis, Vector3 vertex)
 {
 	// slightly shorter reference to the other object's body
+	// (the PhysicsManager has already woken it up if it was asleep)
 	PhysicsBody* otherBody = other->body;
-	otherBody->wakeUp();
 
 	// draw collision axis 
-	if (m_debug)
+	PhysicsDebugDraw* debugDraw = getDebugDraw();
+	if (debugDraw)
 	{
-		aie::Gizmos::addLine(toVec3(m_transform.getPosition()),
-			toVec3(m_transform.getPosition() + axis * 5.0f),
-			glm::vec4(1, 0, 0, 1));
+		debugDraw->drawLine(getPosition(),
+			getPosition() + axis * 5.0f, Vector4(1, 0, 0, 1));
 	}
 
 	// spinny stuff
@@ -470,9 +639,9 @@ void PhysicsBody::resolveCollision(Collider* other, float pen, Vector3 axis, Vec
 		float r2 = (vertex - other->body->getPosition()).dot(perp);
 
 		Vector3 v1;
-		v1.x = m_velocity.dot(axis) - (r1 * m_angularVelocity.x);
-		v1.y = m_velocity.dot(axis) - (r1 * m_angularVelocity.y);
-		v1.z = m_velocity.dot(axis) - (r1 * m_angularVelocity.z);
+		v1.x = getVelocity().dot(axis) - (r1 * getAngularVelocity().x);
+		v1.y = getVelocity().dot(axis) - (r1 * getAngularVelocity().y);
+		v1.z = getVelocity().dot(axis) - (r1 * getAngularVelocity().z);
 
 		Vector3 v2;
 		v2.x = other->body->getVelocity().dot(axis) - (r2 * other->body->getAngularVelocity().x);
@@ -516,46 +685,11 @@ void PhysicsBody::resolveCollision(Collider* other, float pen, Vector3 axis, Vec
 	Vector3 moveB = -1.0f * (pen * bumpB) * axis;
 
 	// move the bodies
-	setPosition(getPosition() + moveA);
-	otherBody->setPosition(otherBody->getPosition() + moveB);
-
-	// get the absolute velocities for handling impulse and stuff
-	Vector3 absVelA;
-	absVelA.x = fabsf(getVelocity().x);
-	absVelA.y = fabsf(getVelocity().y);
-	absVelA.z = fabsf(getVelocity().z);
-
-	Vector3 absVelB;
-	absVelB.x = fabsf(otherBody->getVelocity().x);
-	absVelB.y = fabsf(otherBody->getVelocity().y);
-	absVelB.z = fabsf(otherBody->getVelocity().z);
-
-	// the amount of force to totally cancel out velocity in the
-	//		direction we collided
-	Vector3 pushBackA = axis * absVelA;
-	Vector3 pushBackB = axis * absVelB;
-
-	// the percentage of the velocity to give to the other object
-	float passOnA = massA;
-	float passOnB = massB;
-
-	// static objects don't want to give us any velocity
-	//		because they're greedy (and always have no velocity)
-	// so we'll make sure A tries to give ALL of its velocity to
-	//		B, which won't use it but A will lose that velocity
-	if (otherBody->isStatic())
-	{
-		passOnA = 1.0f;
-		passOnB = 0.0f;
-	}
-
-	Vector3 forceA, forceB;
-
-	forceA = (pushBackA * passOnA) - (pushBackB * passOnB);
-	forceB = (pushBackB * passOnB) - (pushBackA * passOnA);
-
-	addForce(forceA, vertex - getPosition());
-	otherBody->addForce(forceB, vertex - otherBody->getPosition());
+	// static bodies are shared between islands being solved on other
+	// threads, so they're never written to
+	moveTo(getPosition() + moveA);
+	if (!otherBody->isStatic())
+		otherBody->moveTo(otherBody->getPosition() + moveB);
 
     // friction
     float friction = 0.0f;
@@ -572,103 +706,146 @@ void PhysicsBody::resolveCollision(Collider* other, float pen, Vector3 axis, Vec
         default:
             printf("unhandled friction mode %i\n", m_frictionMode);
     }
-	m_velocity -= m_velocity * friction;
-
-	// update both bodies' transforms
-	updateBroadExtents();
-	otherBody->updateBroadExtents();
+	setVelocity(getVelocity() - getVelocity() * friction);
+	// the other body rubs against us just as much
+	if (!otherBody->isStatic())
+		otherBody->setVelocity(otherBody->getVelocity() -
+			otherBody->getVelocity() * friction);
 }
 
-bool PhysicsBody::isCollidingBroad(Collider* other)
+// what a body is tested as in the broad phase, either its broad box or, if
+// it has no points to make one from, its collider as it is (which has to be
+// a box or a sphere)
+struct BroadShape
 {
-	if (!other)
-		return false;
+	bool sphere;
+	Vector3 center;
+	Vector3 extents;
+	float radius;
+};
 
-	// grab this body's collider
-	Collider* thisCol = m_collider;
+static BroadShape getBroadShape(PhysicsBody* body)
+{
+	Collider* col = body->getCollider();
 
-	// use the broad collider if it can be used
-	ColliderAABB broad(getBroadExtents());
-	broad.body = this;
-	if (m_collider->points.getCount() > 0)
-		thisCol = &broad;
+	BroadShape shape;
+	shape.sphere = false;
+	shape.center = body->getPosition();
+	shape.extents = body->getBroadExtents();
+	shape.radius = 0.0f;
 
-	// and get the broad for the other one too
-	ColliderAABB otherBroad(other->body->getBroadExtents());
-	otherBroad.body = other->body;
-	if (other->points.getCount() > 0)
-		other = &otherBroad;
+	if (col->points.getCount() > 0)
+		return shape;
 
 	// broad collision should only be done with AABBs or spheres
 	// so let's check for that
-	assert(thisCol->type == COLLIDER_AABB || thisCol->type == COLLIDER_SPHERE);
-	assert(other->type == COLLIDER_AABB || other->type == COLLIDER_SPHERE);
+	assert(col->type == COLLIDER_AABB || col->type == COLLIDER_SPHERE);
 
-	// make flags of whether or not the colliders are spheres
-	bool thisSphere = (thisCol->type == COLLIDER_SPHERE);
-	bool otherSphere = (other->type == COLLIDER_SPHERE);
-
-	if (thisSphere)
+	if (col->type == COLLIDER_SPHERE)
 	{
-		// this collider is a sphere
-
-		// check collision if the other is a sphere
-		if (otherSphere && PhysicsBody::SpherevsSphere(thisCol, other))
-			return true;
-		// check collision if the other is an AABB
-		if (!otherSphere && PhysicsBody::AABBvsSphere(thisCol, other))
-			return true;
+		ColliderSphere* sphere = (ColliderSphere*)col;
+		shape.sphere = true;
+		shape.center = body->transformPoint(sphere->center);
+		shape.radius = sphere->radius;
 	}
 	else
 	{
-		// this collider is an AABB
-
-		// check collision if the other is a sphere
-		if (otherSphere && PhysicsBody::AABBvsSphere(thisCol, other))
-			return true;
-		// check collision if the other is an AABB
-		if (!otherSphere && PhysicsBody::AABBvsAABB(thisCol, other))
-			return true;
+		shape.extents = ((ColliderAABB*)col)->extents;
 	}
-
-	// no collision!
-	return false;
+	return shape;
 }
 
-bool PhysicsBody::isCollidingSAT(Collider* other, float& penOut, Vector3& axisOut, Vector3& pointOut)
+bool PhysicsBody::isCollidingBroad(Collider* other)
 {
-	// get a slightly shorter reference to our collider
-	Collider* thisCol = m_collider;
+	if (!other)
+		return false;
 
-	// grab a list of all the objects' normals
-	DArray<Vector3> axes;
-	for (int i = 0; i < thisCol->normals.getCount(); ++i)
-		axes.add(rotatePoint(thisCol->normals[i]));
-	for (int i = 0; i < other->normals.getCount(); ++i)
-		axes.add(other->body->rotatePoint(other->normals[i]));
+	// the shapes are tested as plain values, making colliders for the broad
+	// boxes would allocate their points every time
+	BroadShape thisShape = getBroadShape(this);
+	BroadShape otherShape = getBroadShape(other->body);
 
-	// transform the colliders' points to world position
-	DArray<Vector3> thisPoints;
-	for (int i = 0; i < thisCol->points.getCount(); ++i)
+	if (thisShape.sphere && otherShape.sphere)
 	{
-		// transform the point based on this body's transform matrix
-		Vector3 pt = transformPoint(thisCol->points[i]);
-		thisPoints.add(pt);
+		// test the distance between their centers against their combined
+		// radii
+		float rad = thisShape.radius + otherShape.radius;
+		return thisShape.center.distanceToSquared(otherShape.center) <=
+			rad * rad;
 	}
+	if (thisShape.sphere)
+		return AABBvsSphere(otherShape.center, otherShape.extents,
+			thisShape.center, thisShape.radius);
+	if (otherShape.sphere)
+		return AABBvsSphere(thisShape.center, thisShape.extents,
+			otherShape.center, otherShape.radius);
+
+	return AABBvsAABB(thisShape.center, thisShape.extents,
+		otherShape.center, otherShape.extents);
+}
+
+bool PhysicsBody::isCollidingSAT(Collider* other, float& penOut,
+	Vector3& axisOut, Vector3& pointOut, int& axisIndex)
+{
+	// get a slightly shorter reference to our collider
+	Collider* thisCol = m_collider;
 
-	DArray<Vector3> otherPoints;
-	for (int i = 0; i < other->points.getCount(); ++i)
+	// try the hinted axis on its own first, it usually separates bodies
+	// that aren't touching and checking it this way skips transforming
+	// every point, which is most of the work
+	int thisNormals = thisCol->normals.getCount();
+	if (axisIndex >= 0 &&
+		axisIndex < thisNormals + other->normals.getCount())
 	{
-		// transform the point based on its body's transform matrix
-		Vector3 pt = other->body->transformPoint(other->points[i]);
-		otherPoints.add(pt);
+		Vector3 axis = axisIndex < thisNormals ?
+			rotatePoint(thisCol->normals[axisIndex]) :
+			other->body->rotatePoint(other->normals[axisIndex - thisNormals]);
+
+		float mina, maxa, minb, maxb;
+		projectCollider(axis, mina, maxa);
+		other->body->projectCollider(axis, minb, maxb);
+
+		// still separated along the same axis
+		if (maxa - minb <= 0.0f || maxb - mina <= 0.0f)
+			return false;
 	}
 
-	DArray<Vector3> penPoints;
-	DArray<float> penetrations;
+	// everything below only lives as long as this check, so it comes out
+	// of this thread's scratch memory instead of the heap
+	ArenaScope scratch(Arena::getThreadArena());
+
+	// grab a list of all the objects' normals, both bodies already have
+	// theirs in the world
+	int otherNormals = other->normals.getCount();
+	int axisCount = thisNormals + otherNormals;
+	Vector3* axes = scratch.alloc<Vector3>(axisCount);
+	Vector3* worldNormals = getWorldNormals();
+	for (int i = 0; i < thisNormals; ++i)
+		axes[i] = worldNormals[i];
+	worldNormals = other->body->getWorldNormals();
+	for (int i = 0; i < otherNormals; ++i)
+		axes[thisNormals + i] = worldNormals[i];
+
+	// and their points too
+	int thisCount = thisCol->points.getCount();
+	Vector3* thisPoints = getWorldPoints();
+	int otherCount = other->points.getCount();
+	Vector3* otherPoints = other->body->getWorldPoints();
+
+	// these are kept in the same order as the axes, no matter which order
+	// the axes are checked in
+	Vector3* penPoints = scratch.alloc<Vector3>(axisCount);
+	float* penetrations = scratch.alloc<float>(axisCount);
+
+	// check the hinted axis first by swapping it with the first one
+	int first = axisIndex;
+	if (first < 0 || first >= axisCount)
+		first = 0;
+
 	// start checking for overlaps!
-	for (int i = 0; i < axes.getCount(); ++i)
+	for (int n = 0; n < axisCount; ++n)
 	{
+		int i = n == 0 ? first : (n == first ? 0 : n);
 		Vector3 axis = axes[i];
 
 		float mina = INFINITY;
@@ -679,7 +856,7 @@ bool PhysicsBody::isCollidingSAT(Collider* other, float& penOut, Vector3& axisOu
 		int minIndex = -1;
 		int maxIndex = -1;
 		// project each vertex of this shape onto the current axis
-		for (int j = 0; j < thisPoints.getCount(); ++j)
+		for (int j = 0; j < thisCount; ++j)
 		{
 			Vector3 pt = thisPoints[j];
 			float dot = axis.dot(pt);
@@ -696,7 +873,7 @@ bool PhysicsBody::isCollidingSAT(Collider* other, float& penOut, Vector3& axisOu
 			}
 		}
 		// project each vertex of the other shape onto the current axis
-		for (int j = 0; j < otherPoints.getCount(); ++j)
+		for (int j = 0; j < otherCount; ++j)
 		{
 			Vector3 pt = otherPoints[j];
 			float dot = axis.dot(pt);
@@ -720,21 +897,25 @@ bool PhysicsBody::isCollidingSAT(Collider* other, float& penOut, Vector3& axisOu
 
 		// they're not colliding if there's no overlap on an axis
 		if (overlap <= 0.0f)
+		{
+			axisIndex = i;
 			return false;
+		}
 
 		// keep track of this amount of overlap to find the axis of collision
-		penetrations.add(overlap);
+		penetrations[i] = overlap;
 		// and keep track of the point most responsible for this overlap
-		penPoints.add(thisPoints[pointIndex]);
+		penPoints[i] = thisPoints[pointIndex];
 	}
 
 	// get the lowest penetration's index
 	int lowest = 0;
-	for (int i = 0; i < penetrations.getCount(); ++i)
+	for (int i = 0; i < axisCount; ++i)
 		if (penetrations[i] < penetrations[lowest])
 			lowest = i;
 
 	// output this penetration value
+	axisIndex = lowest;
 	penOut = penetrations[lowest];
 	// and that penetration's most responsible point
 	pointOut = penPoints[lowest];
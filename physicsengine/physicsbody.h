@@ -5,14 +5,23 @@
 #pragma once
 
 #include <darray.h>
+#include <octcube.h>
 #include <matrix4.h>
+#include <transform.h>
 #include <vector3.h>
 #include <functional> // for std::function
 
+#include "bodystore.h"
+
 struct Collider;
+class PhysicsDebugDraw;
+class PhysicsBody;
+struct ContactManifold;
 
 #define MIN_LINEAR_THRESHOLD 0.1f
 #define MIN_ROTATIONAL_THRESHOLD 0.1f
+// how long a body has to stay still before it's allowed to sleep
+#define SLEEP_TIME 3.0f
 
 enum FrictionMode {
     FRICTION_MIN,
@@ -20,82 +29,215 @@ enum FrictionMode {
     FRICTION_AVG
 };
 
+// a collision found in the narrow phase, waiting to be solved
+struct PhysicsContact
+{
+	// the body that went looking for this collision
+	PhysicsBody* a;
+	// the body it found
+	PhysicsBody* b;
+
+	// both bodies' ids packed together, lower id in the top half
+	// contacts are sorted by this so they're always solved in the same order
+	unsigned long long key;
+
+	float penetration;
+	// points from b towards a
+	Vector3 axis;
+	// point most responsible for the collision
+	Vector3 point;
+
+	// how hard this pair has been pushed apart over the last few steps,
+	// filled in by the PhysicsManager before the contact is solved
+	ContactManifold* manifold;
+};
+
 class PhysicsBody
 {
 public:
+	// the PhysicsManager has to exist before any bodies are made, since it
+	// owns the store their data goes in
 	PhysicsBody(Collider* collider = nullptr);
 	~PhysicsBody();
 
-	void update(float delta);
+	// stages of a physics step, called in order by the PhysicsManager
+	// (integration is done for every body at once by the BodyStore)
+	// keeps track of how long the body hasn't moved for, the PhysicsManager
+	// puts it to sleep along with everything it's touching
+	void updateSleep(float delta);
+	// draws debug information about where the body ended up
+	void drawDebug();
 
 	// collider getter/setter
 	void setCollider(Collider* c);
 	inline Collider* getCollider() { return m_collider; }
 
-	// set the entire transform of the body
+	// set the entire transform of the body, the matrix shouldn't be scaled
 	void setTransform(Matrix4 const& m);
+	void setTransform(Transform const& t);
 	// set just the position part of the transform
+	// this is a teleport, so the body isn't drawn sliding over to it from
+	// wherever it was
 	void setPosition(Vector3 const& v);
+	// moves the body part way through a step (pushing it out of something,
+	// sweeping it back), so it's still drawn moving from where it was
+	void moveTo(Vector3 const& v);
 	// set just the rotation part of the transform
 	void setRotation(Vector3 const& v);
 
-	// adds a rotation to the body
+	// adds a rotation to the body, in its own space
+	// v is the axis to turn around scaled by how far to turn (in radians)
 	void rotate(Vector3 const& v);
 
 	// grab the position out of the transform matrix
 	Vector3 getPosition();
 
 	// setters for velocities
-	void setVelocity(Vector3 const& v) { m_velocity = v; }
-	void setAngularVelocity(Vector3 const& v) { m_angularVelocity = v; }
+	void setVelocity(Vector3 const& v)
+	{
+		m_store->velX[m_index] = v.x;
+		m_store->velY[m_index] = v.y;
+		m_store->velZ[m_index] = v.z;
+	}
+	void setAngularVelocity(Vector3 const& v)
+	{
+		m_store->angX[m_index] = v.x;
+		m_store->angY[m_index] = v.y;
+		m_store->angZ[m_index] = v.z;
+	}
 
 	// getters for velocities
-	inline Vector3 getVelocity() { return m_velocity; }
-	inline Vector3 getAngularVelocity() { return m_angularVelocity; }
+	inline Vector3 getVelocity()
+	{
+		return Vector3(m_store->velX[m_index], m_store->velY[m_index],
+			m_store->velZ[m_index]);
+	}
+	inline Vector3 getAngularVelocity()
+	{
+		return Vector3(m_store->angX[m_index], m_store->angY[m_index],
+			m_store->angZ[m_index]);
+	}
 
 	// adds some velocity
 	void addForce(Vector3 force, Vector3 pos);
 
 	// set physical properties of the body
 	// bounce and friction aren't implemented yet!
-	void setDrag(float d) { m_drag = d; }
-	void setMass(float m) { m_mass = m; }
+	void setDrag(float d) { m_store->drag[m_index] = d; }
+	void setMass(float m);
 	void setBounce(float b) { m_bounce = b; }
 	void setFriction(float f) { m_friction = f; }
 	void setFrictionMode(FrictionMode m) { m_frictionMode = m; }
 
 	// get physical properties of the body
-	inline float getDrag() { return m_drag; }
-	inline float getMass() { return m_mass; }
+	inline float getDrag() { return m_store->drag[m_index]; }
+	inline float getMass() { return m_store->mass[m_index]; }
+	// 1/mass, or 0 for static bodies
+	inline float getInverseMass() { return m_store->invMass[m_index]; }
 	inline float getBounce() { return m_bounce; }
 	inline float getFriction() { return m_friction; }
 	inline float getMomentOfInertia() { return m_momentOfInertia; }
 	inline FrictionMode getFrictionMode() { return m_frictionMode; }
 
 	// change whether or not this body is affected by gravity
-	void setUseGravity(bool g) { m_useGravity = g; }
+	void setUseGravity(bool g)
+	{
+		m_store->gravityScale[m_index] = g ? 1.0f : 0.0f;
+	}
 
 	// getter/setter for enabled - whether or not physics happens on this body
-	bool isEnabled() { return m_enabled; }
-	void setEnabled(bool b) { m_enabled = b; }
+	bool isEnabled() { return hasFlag(BODY_ENABLED); }
+	void setEnabled(bool b) { setFlag(BODY_ENABLED, b); }
 
 	// getter/setter for staticness - whether or not the body can move
-	bool isStatic() { return m_static; }
-	void setStatic(bool s) { m_static = s; }
+	bool isStatic() { return hasFlag(BODY_STATIC); }
+	void setStatic(bool s);
 
 	// getter/setter for zone - zones allow objects to intersect them and
 	// simply detect these objects, could be called a 'sensor'
-	bool isZone() { return m_zone; }
-	void setZone(bool z) { m_zone = z; }
+	bool isZone() { return hasFlag(BODY_ZONE); }
+	void setZone(bool z) { setFlag(BODY_ZONE, z); }
+
+	// getter/setter for continuous collision - when the body moves further
+	// than its own thickness in a step it's swept from where it was to
+	// where it ended up, so it can't pass through anything thin
+	bool isContinuous() { return hasFlag(BODY_CONTINUOUS); }
+	void setContinuous(bool c)
+	{
+		setFlag(BODY_CONTINUOUS, c);
+		if (!c)
+			m_swept = false;
+	}
+	// whether or not the body is being swept this step, and how far it
+	// moved if it is - its broad box stretches back over the whole move
+	bool isSwept() { return m_swept; }
+	Vector3 getSweep() { return m_sweep; }
+	// works out whether the body needs sweeping after it's been integrated
+	void updateSweep(float delta);
+
+	// whether or not the body is sleeping
+	bool isAsleep() { return hasFlag(BODY_ASLEEP); }
+	// whether or not the body has been still long enough to sleep
+	bool isStill() { return m_stillTime >= SLEEP_TIME; }
+	// puts the body to sleep as part of a sleeping island, which the
+	// PhysicsManager wakes all at once
+	void sleep(int island);
+	// which of the PhysicsManager's sleeping islands the body is in, -1 if
+	// it's awake
+	int getSleepIsland() { return m_sleepIsland; }
+	void setSleepIsland(int island) { m_sleepIsland = island; }
+
+	// whether or not the body stays where it is without being moved by hand,
+	// which is static bodies (but not zones, they still look for things)
+	// and sleeping ones
+	// the broadphase keeps these apart and only updates them when they move
+	bool isResting();
+	// whether or not the body's been moved or resized since the broadphase
+	// last looked at it
+	bool hasMovedBroad() { return hasFlag(BODY_BROAD_MOVED); }
+	void clearMovedBroad() { setFlag(BODY_BROAD_MOVED, false); }
+
+	// whether or not the body has been added to the PhysicsManager
+	void setInWorld(bool w) { setFlag(BODY_IN_WORLD, w); }
+
+	// slot in the BodyStore this body's data is kept in
+	int getIndex() { return m_index; }
 
 	// set whether or not debug information is shown
 	void setDebug(bool d) { m_debug = d; }
 
+	// the collider's points and normals moved to where the body is, updated
+	// once after the body's moved instead of every time they're needed
+	// line up with the collider's points and normals
+	Vector3* getWorldPoints();
+	Vector3* getWorldNormals();
+	// puts the collider's points and normals into the world right now, the
+	// PhysicsManager does this for everything that moved after integrating
+	void updateWorldShape();
+	// lets the body know its collider's points changed
+	void setShapeDirty() { setFlag(BODY_SHAPE_DIRTY, true); }
+
 	// transforms a point by just the rotation of the matrix
 	Vector3 rotatePoint(Vector3 const& pt);
 	// tramsforms a point by the whole transform matrix
 	Vector3 transformPoint(Vector3 const& pt);
-
+	// takes a point in the world back into the body's own space
+	Vector3 inverseTransformPoint(Vector3 const& pt);
+	// undoes just the rotation of the matrix
+	Vector3 inverseRotatePoint(Vector3 const& pt);
+
+	// where the body is and which way it's facing
+	Transform getTransform();
+	Quaternion getOrientation() { return m_store->orientations[m_index]; }
+	// where the body should be drawn between its last two steps, 0 is where
+	// it was before the last step and 1 is where it is now
+	Transform getInterpolatedTransform(float alpha);
+	// makes the body look like it's been where it is now since before the
+	// last step, so it isn't drawn sliding in from wherever it was before
+	// being put there
+	void resetInterpolation();
+
+	// the same as matrices, made when they're asked for (for rendering)
 	// get just the rotation portion of the transform matrix
 	Matrix4 getRotationMatrix();
 	// get the whole transform matrix
@@ -106,44 +248,85 @@ public:
 	Vector3	getBroadExtents() { return m_broadExtents; }
 	// updates those extents to fit around the body
 	void updateBroadExtents();
+	// the broad phase box as a volume the broadphase structures can use
+	OctCube getBroadCube();
 
+	// unique id the PhysicsManager gives the body when it's added, used to
+	// keep broadphase pairs in a consistent order
+	int getId() { return m_id; }
+	void setId(int id) { m_id = id; }
+
+	// bodies this body collided with during the last step
 	DArray<PhysicsBody*>& getCollidingBodies() { return m_colliding; }
 
+	// whether or not this body goes looking for collisions itself, bodies
+	// that don't (static and sleeping bodies) only get collided with
+	bool checksCollision();
+	// does narrow phase collision against another body, filling in a contact
+	// if they're colliding
+	// axis is the SAT axis to try first (-1 for none), and comes back as the
+	// axis that separated them or the one they're colliding along (or -1 if
+	// the broad phase check already ruled them out)
+	bool findContact(PhysicsBody* other, PhysicsContact& contact, int& axis);
+	// pushes the bodies in a contact this body found out of each other and
+	// applies friction, each pair of bodies should only be solved once per
+	// step and after the contact's manifold has solved their velocities
+	// only ever touches the two bodies in the contact (and never static
+	// ones), so contacts in different islands can be solved at the same time
+	void solveContact(PhysicsContact const& contact);
+	// tells both bodies in a solved contact about each other, this calls
+	// back into game code so it's done one contact at a time
+	void reportContact(PhysicsContact const& contact);
+
 	// specific broad phase collision functions
 	static bool AABBvsAABB(Collider* c1, Collider* c2);
 	static bool AABBvsSphere(Collider* _aabb, Collider* _sphere);
 	static bool SpherevsSphere(Collider* c1, Collider* c2);
+	// the same tests on shapes that aren't colliders, so broad boxes don't
+	// need colliders made for them
+	static bool AABBvsAABB(Vector3 const& pos1, Vector3 const& ext1,
+		Vector3 const& pos2, Vector3 const& ext2);
+	static bool AABBvsSphere(Vector3 const& pos, Vector3 const& extents,
+		Vector3 const& center, float radius);
 
 	// general broad phase collision detection
 	bool isCollidingBroad(Collider* other);
-	// narrow phase collision detection
-	bool isCollidingSAT(Collider* other, float& penOut, Vector3& axisOut, Vector3& pointOut);
+	// narrow phase collision detection against every point and normal, used
+	// for colliders that don't have an exact test in the Narrowphase
+	// axisIndex works the same as findContact's axis, an axis that separated
+	// the bodies last time usually still does, so trying it first lets
+	// pairs that aren't touching skip every other axis
+	bool isCollidingSAT(Collider* other, float& penOut, Vector3& axisOut,
+		Vector3& pointOut, int& axisIndex);
 
 	bool rayTestBroad(Vector3 const& start, Vector3 const& dir, float* outDist);
 
 	void setCollideCallback(std::function<void(PhysicsBody*)> func) 
 	{ m_collideCallback = func; }
 
-	// stops the body from sleeping
+	// stops the body from sleeping, along with the rest of its island
 	void wakeUp();
 
 private:
 	Collider* m_collider;
 
-	Vector3 m_velocity;
-	Vector3 m_angularVelocity;
-
-	float m_drag;
-	float m_angularDrag;
-
-	Matrix4 m_transform;
+	// where the body's position, velocities, mass and flags are kept
+	BodyStore* m_store;
+	int m_index;
 
 	// store broad extents so we don't have to calculate them each time we
 	// test collision
 	Vector3 m_broadExtents;
 
+	// see getWorldPoints
+	DArray<Vector3> m_worldPoints;
+	DArray<Vector3> m_worldNormals;
+
+	// see isSwept
+	bool m_swept;
+	Vector3 m_sweep;
+
 	// physical properties
-	float m_mass;
 	float m_bounce;
 	float m_momentOfInertia;
 
@@ -153,33 +336,40 @@ private:
 	// list of currently colliding bodies
 	DArray<PhysicsBody*> m_colliding;
 
-	bool m_debug;
+	int m_id;
 
-	// whether or not this body is a zone/sensor
-	bool m_zone;
-	// whether or not this body can move
-	bool m_static;
+	bool m_debug;
 
 	// sleeping variables
-	bool m_asleep;
 	// amount of time the body hasn't moved
 	float m_stillTime;
 	// vector to keep track of its last position so we know if we can put it
 	// to sleep
 	Vector3 m_stillPos;
+	// sleeping island the body is in, -1 when awake
+	int m_sleepIsland;
 
-	bool m_enabled;
+	std::function<void(PhysicsBody*)> m_collideCallback;
 
-	bool m_useGravity;
-	float m_gravityStrength;
+	// grabs the debug drawer if this body should draw debug information
+	PhysicsDebugDraw* getDebugDraw();
 
-	std::function<void(PhysicsBody*)> m_collideCallback;
+	bool hasFlag(int flag) { return (m_store->flags[m_index] & flag) != 0; }
+	void setFlag(int flag, bool on)
+	{
+		if (on)
+			m_store->flags[m_index] |= flag;
+		else
+			m_store->flags[m_index] &= ~flag;
+	}
 
-	// checks collision against every body in the world and resolves it
-	void checkCollision();
+	// finds the range the collider's points cover along an axis, without
+	// transforming each point into the world
+	void projectCollider(Vector3 const& axis, float& min, float& max);
 
 	// resolves collision by pushing objects out of each other and applying
-	// relevant forces
+	// friction, stopping them moving into each other is left to the
+	// contact's manifold
 	void resolveCollision(Collider* other, float pen, Vector3 axis, Vector3 vertex);
 
 };
@@ -0,0 +1,29 @@
+/* =================================
+ *  PhysicsDebugDraw
+ *  Interface the physics code draws its debug information through, so the
+ *  physics library doesn't need to know anything about Gizmos or OpenGL
+ *
+ *  Give the PhysicsManager an implementation to see debug drawing:
+ *		phys->setDebugDraw(new GizmoDebugDraw());
+ *	Without one, debug drawing is just skipped
+ * ================================= */
+#pragma once
+
+#include <vector3.h>
+#include <vector4.h>
+
+class PhysicsDebugDraw
+{
+public:
+	virtual ~PhysicsDebugDraw() {}
+
+	// draws a line between two points
+	virtual void drawLine(Vector3 const& start, Vector3 const& end,
+		Vector4 const& color) = 0;
+	// draws the outline of an axis-aligned box
+	virtual void drawBox(Vector3 const& center, Vector3 const& extents,
+		Vector4 const& color) = 0;
+	// draws a small sphere, mostly used to mark points
+	virtual void drawSphere(Vector3 const& center, float radius,
+		Vector4 const& color) = 0;
+};
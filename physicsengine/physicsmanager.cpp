@@ -4,17 +4,26 @@
  * ================================= */
 #include "physicsmanager.h"
 
-#include <Gizmos.h>
+#include <cmath>
+#include <cfloat>
+#include <chrono>
+#include <jobsystem.h>
 
-#include "util.h"
+#include "ccd.h"
 #include "physicsbody.h"
+#include "physicsdebug.h"
 #include "collideraabb.h"
 
 float PhysicsManager::gravity = 9.8f;
+int PhysicsManager::velocityIterations = 4;
 
 PhysicsManager* PhysicsManager::m_instance = nullptr;
 
 PhysicsManager::PhysicsManager()
+	: m_broadphase(BROADPHASE_SAP), m_restingTree(0.0f, 0.0f), m_nextId(0),
+	m_axisHits(0),
+	m_axisMisses(0), m_step(0),
+	m_islandCount(0), m_jobs(nullptr), m_debugDraw(nullptr)
 {
 	// arbitrary extent of the octree
 	// no collision will work outside of this range
@@ -22,15 +31,28 @@ PhysicsManager::PhysicsManager()
 	m_tree = new Octree<PhysicsBody*>(3,
 		{ -treeSize, -treeSize, -treeSize,
 		treeSize, treeSize, treeSize });
+
+	for (int i = 0; i < STAGE_COUNT; ++i)
+		m_stageTimes[i] = 0.0f;
 }
 
 PhysicsManager::~PhysicsManager()
 {
 	delete m_tree;
+
+	for (int i = 0; i < m_threadContacts.getCount(); ++i)
+		delete m_threadContacts[i];
+	for (int i = 0; i < m_islands.getCount(); ++i)
+		delete m_islands[i];
+	for (int i = 0; i < m_sleepingIslands.getCount(); ++i)
+		delete m_sleepingIslands[i];
 }
 
 void PhysicsManager::drawTree(Octree<PhysicsBody*>* tree)
 {
+	if (!m_debugDraw)
+		return;
+
 	// turn this tree's bounds into vectors so we can use them
 	OctCube volume = tree->getBounds();
 
@@ -40,8 +62,7 @@ void PhysicsManager::drawTree(Octree<PhysicsBody*>* tree)
 	Vector3 extents = (max - min) / 2.0f;
 	Vector3 center = min + extents;
 
-	aie::Gizmos::addAABB(toVec3(center), toVec3(extents),
-		glm::vec4(0, 0, 0, 1));
+	m_debugDraw->drawBox(center, extents, Vector4(0, 0, 0, 1));
 
 	// recursively draw this tree's children
 	if (tree->isDivided())
@@ -57,6 +78,7 @@ void PhysicsManager::create()
 void PhysicsManager::destroy()
 {
 	delete m_instance;
+	m_instance = nullptr;
 }
 
 PhysicsManager* PhysicsManager::getInstance()
@@ -66,43 +88,749 @@ PhysicsManager* PhysicsManager::getInstance()
 
 void PhysicsManager::addPhysicsBody(PhysicsBody* b)
 {
+	b->setId(m_nextId++);
+	b->setInWorld(true);
+	// it's only just been put wherever it is
+	b->resetInterpolation();
 	m_bodies.add(b);
+	// it'll be put into the broadphase next update
+	m_broadHandles.add(-1);
+	m_restingHandles.add(-1);
 }
 
 void PhysicsManager::update(float delta)
 {
-	// SUPER BASIC APPROACH, just clearing and re-inserting all bodies into
-	// the tree each frame
-	// not ideal, but the performance improvement from not using an octree
-	// at all is already substantial using this
-	m_tree->clear();
+	typedef std::chrono::high_resolution_clock Clock;
+
+	// runs a stage and keeps track of how long it took
+	auto runStage = [this](PhysicsStage stage, auto func)
+	{
+		auto start = Clock::now();
+		func();
+		std::chrono::duration<float, std::milli> time = Clock::now() - start;
+		m_stageTimes[stage] = time.count();
+	};
+
+	m_step++;
+
+	runStage(STAGE_INTEGRATE, [&]() { integrate(delta); });
+	runStage(STAGE_BROADPHASE, [&]()
+	{
+		updateBroadphase(delta);
+		sweepFastBodies(delta);
+	});
+	runStage(STAGE_NARROWPHASE, [&]() { narrowphase(); });
+	runStage(STAGE_SOLVE, [&]() { solve(); });
+	runStage(STAGE_SLEEP, [&]() { updateSleep(delta); });
+	runStage(STAGE_SYNC, [&]() { sync(); });
+}
+
+const char* PhysicsManager::getStageName(PhysicsStage stage)
+{
+	switch (stage)
+	{
+	case STAGE_INTEGRATE: return "integrate";
+	case STAGE_BROADPHASE: return "broadphase";
+	case STAGE_NARROWPHASE: return "narrowphase";
+	case STAGE_SOLVE: return "solve";
+	case STAGE_SLEEP: return "sleep";
+	case STAGE_SYNC: return "sync";
+	default: return "unknown";
+	}
+}
+
+void PhysicsManager::forRange(int count, int batchSize,
+	std::function<void(int, int)> func)
+{
+	if (m_jobs)
+		m_jobs->parallelFor(count, batchSize, func);
+	else
+		func(0, count);
+}
+
+void PhysicsManager::integrate(float delta)
+{
+	// every body is integrated straight from the store's arrays
+	int count = m_bodyStore.getCount();
+	forRange(count, 1024, [this, delta](int start, int end)
+	{
+		m_bodyStore.integrate(start, end, delta, gravity);
+	});
+
+	// moving doesn't change the size of the broad box, but rotating does
+	// and everything that moved puts its points back into the world once
+	// here, instead of every time they're needed
+	// nothing moves again until the solver, so nothing will need updating
+	// while the narrowphase is reading them from other threads
+	// continuous bodies also work out whether they moved far enough to need
+	// sweeping, before the broadphase uses their boxes
+	forRange(count, 256, [this, delta](int start, int end)
+	{
+		for (int i = start; i < end; ++i)
+		{
+			int& flags = m_bodyStore.flags[i];
+			if (flags & BODY_ROTATED)
+			{
+				m_bodyStore.bodies[i]->updateBroadExtents();
+				flags &= ~BODY_ROTATED;
+			}
+			if ((flags & BODY_SHAPE_DIRTY) && (flags & BODY_IN_WORLD))
+				m_bodyStore.bodies[i]->updateWorldShape();
+			if (flags & BODY_CONTINUOUS)
+				m_bodyStore.bodies[i]->updateSweep(delta);
+		}
+	});
+}
+
+// sort order of sweep pairs, so each swept body's pairs are together
+static bool sweepBefore(SAPPair<PhysicsBody*> lhs, SAPPair<PhysicsBody*> rhs)
+{
+	return lhs.a->getId() < rhs.a->getId();
+}
+
+void PhysicsManager::sweepFastBodies(float delta)
+{
+	// the broadphase used swept boxes, so every pair a swept body could have
+	// hit on its way is in here
+	m_sweepPairs.clear();
+	for (int i = 0; i < m_pairs.getCount(); ++i)
+	{
+		SAPPair<PhysicsBody*>& pair = m_pairs[i];
+		if (pair.a->isSwept())
+			m_sweepPairs.add({ pair.a, pair.b });
+		if (pair.b->isSwept())
+			m_sweepPairs.add({ pair.b, pair.a });
+	}
+	if (m_sweepPairs.getCount() == 0)
+		return;
+
+	// there's only ever a few of these, so it's not worth spreading out
+	m_sweepPairs.heapSort(sweepBefore);
+	int start = 0;
+	while (start < m_sweepPairs.getCount())
+	{
+		PhysicsBody* body = m_sweepPairs[start].a;
+		m_sweepOthers.clear();
+		int end = start;
+		for (; end < m_sweepPairs.getCount() &&
+			m_sweepPairs[end].a == body; ++end)
+			m_sweepOthers.add(m_sweepPairs[end].b);
+		start = end;
+
+		// it's already been put into the world once this step
+		if (CCD::sweep(body, m_sweepOthers, delta))
+			body->updateWorldShape();
+	}
+}
+
+// sort order of contacts, by the ids of the bodies in them
+static bool contactBefore(PhysicsContact lhs, PhysicsContact rhs)
+{
+	return lhs.key < rhs.key;
+}
+
+// packs a pair's ids together the same way contact keys are, lower id first
+static unsigned long long pairKey(PhysicsBody* a, PhysicsBody* b)
+{
+	int low = a->getId() < b->getId() ? a->getId() : b->getId();
+	int high = a->getId() < b->getId() ? b->getId() : a->getId();
+	return ((unsigned long long)low << 32) | (unsigned int)high;
+}
+
+void PhysicsManager::narrowphase()
+{
+	// make sure every thread has a buffer, plus one on the end for a thread
+	// that isn't the job system's (it can still end up running a range
+	// itself when the whole thing fits in one batch)
+	int threads = m_jobs ? m_jobs->getThreadCount() + 1 : 1;
+	while (m_threadContacts.getCount() < threads)
+		m_threadContacts.add(new DArray<PhysicsContact>());
+	for (int i = 0; i < m_threadContacts.getCount(); ++i)
+		m_threadContacts[i]->clear();
+
+	while (m_pairResults.getCount() < m_pairs.getCount())
+		m_pairResults.add(PairResult());
+
+	forRange(m_pairs.getCount(), 32, [this](int start, int end)
+	{
+		findContacts(start, end);
+	});
+
+	// merge everyone's contacts and sort them, which threads found which
+	// contacts changes every time but the sorted order doesn't
+	m_contacts.clear();
+	for (int i = 0; i < m_threadContacts.getCount(); ++i)
+	{
+		DArray<PhysicsContact>& found = *m_threadContacts[i];
+		for (int j = 0; j < found.getCount(); ++j)
+			m_contacts.add(found[j]);
+	}
+	m_contacts.heapSort(contactBefore);
+
+	updateAxisCache();
+}
+
+void PhysicsManager::findContacts(int start, int end)
+{
+	int thread = m_jobs ? m_jobs->getThreadIndex() : 0;
+	if (thread < 0)
+		thread = m_threadContacts.getCount() - 1;
+	DArray<PhysicsContact>& found = *m_threadContacts[thread];
+
+	for (int i = start; i < end; ++i)
+	{
+		PhysicsBody* a = m_pairs[i].a;
+		PhysicsBody* b = m_pairs[i].b;
+
+		PairResult& result = m_pairResults[i];
+
+		// the body doing the checking has to be one that actually looks for
+		// collisions, if neither does (static against static or two sleeping
+		// bodies) then there's nothing to do
+		if (!a->checksCollision())
+		{
+			if (!b->checksCollision())
+			{
+				result.checker = -1;
+				continue;
+			}
+
+			PhysicsBody* temp = a;
+			a = b;
+			b = temp;
+		}
+
+		// nothing's added to the cache until every thread is done, so it's
+		// safe to read from here
+		result.checker = a->getId();
+		result.hint = -1;
+		CachedAxis* cached = m_axisCache.find(pairKey(a, b));
+		if (cached && cached->checker == result.checker)
+			result.hint = cached->axis;
+
+		result.axis = result.hint;
+		PhysicsContact contact;
+		if (a->findContact(b, contact, result.axis))
+			found.add(contact);
+	}
+}
+
+void PhysicsManager::updateAxisCache()
+{
+	m_axisHits = 0;
+	m_axisMisses = 0;
+
+	for (int i = 0; i < m_pairs.getCount(); ++i)
+	{
+		PairResult& result = m_pairResults[i];
+		if (result.checker < 0)
+			continue;
+
+		CachedAxis& cached = m_axisCache[pairKey(m_pairs[i].a, m_pairs[i].b)];
+		cached.lastStep = m_step;
+
+		// the broad phase check ruled it out, so whatever axis was cached
+		// hasn't been proven wrong
+		if (result.axis < 0)
+			continue;
+
+		if (result.hint >= 0 && result.axis == result.hint)
+			m_axisHits++;
+		else
+			m_axisMisses++;
+
+		cached.checker = result.checker;
+		cached.axis = result.axis;
+	}
+
+	// throw away pairs the broadphase doesn't think are close anymore
+	m_cacheKeys.clear();
+	m_axisCache.getKeys(m_cacheKeys);
+	for (int i = 0; i < m_cacheKeys.getCount(); ++i)
+	{
+		unsigned long long key = m_cacheKeys[i];
+		if (m_axisCache.find(key)->lastStep != m_step)
+			m_axisCache.remove(key);
+	}
+}
+
+// whether a body can be part of an island
+static bool inIsland(PhysicsBody* body)
+{
+	return body->isEnabled() && body->getCollider() && !body->isStatic() &&
+		!body->isAsleep();
+}
+
+// whether a contact actually gets resolved, rather than just reported
+static bool isSolid(PhysicsContact const& contact)
+{
+	return !contact.a->isZone() && !contact.b->isZone();
+}
+
+int PhysicsManager::findIsland(int slot)
+{
+	// point everything on the way up at its grandparent, so the path gets
+	// shorter every time it's walked
+	while (m_islandParent[slot] != slot)
+	{
+		m_islandParent[slot] = m_islandParent[m_islandParent[slot]];
+		slot = m_islandParent[slot];
+	}
+	return slot;
+}
+
+void PhysicsManager::joinIslands(int a, int b)
+{
+	a = findIsland(a);
+	b = findIsland(b);
+
+	// the lower slot always ends up as the root, so the islands come out the
+	// same no matter what order contacts are joined in
+	if (a < b)
+		m_islandParent[b] = a;
+	else if (b < a)
+		m_islandParent[a] = b;
+}
+
+void PhysicsManager::buildIslands()
+{
+	int slots = m_bodyStore.getCount();
+	while (m_islandParent.getCount() < slots)
+	{
+		m_islandParent.add(0);
+		m_islandIndex.add(0);
+	}
+	for (int i = 0; i < slots; ++i)
+	{
+		m_islandParent[i] = i;
+		m_islandIndex[i] = -1;
+	}
+
+	// anything that got hit while it was asleep wakes up (with the rest of
+	// its sleeping island) before the islands are built, so it's solved along
+	// with whatever hit it
+	for (int i = 0; i < m_contacts.getCount(); ++i)
+	{
+		PhysicsContact& contact = m_contacts[i];
+		if (isSolid(contact))
+			contact.b->wakeUp();
+	}
+
+	// static bodies are left out, otherwise everything on the floor would be
+	// one big island
+	for (int i = 0; i < m_contacts.getCount(); ++i)
+	{
+		PhysicsContact& contact = m_contacts[i];
+		if (isSolid(contact) && !contact.b->isStatic())
+			joinIslands(contact.a->getIndex(), contact.b->getIndex());
+	}
+
+	// bodies that aren't touching anything are still an island by themselves,
+	// so they can go to sleep
+	m_islandCount = 0;
 	for (int i = 0; i < m_bodies.getCount(); ++i)
 	{
-		auto body = m_bodies[i];
-		if (body->isEnabled())
+		PhysicsBody* body = m_bodies[i];
+		if (!inIsland(body))
+			continue;
+
+		int root = findIsland(body->getIndex());
+		if (m_islandIndex[root] < 0)
+		{
+			if (m_islandCount == m_islands.getCount())
+				m_islands.add(new PhysicsIsland());
+
+			PhysicsIsland* island = m_islands[m_islandCount];
+			island->bodies.clear();
+			island->contacts.clear();
+			m_islandIndex[root] = m_islandCount++;
+		}
+		m_islands[m_islandIndex[root]]->bodies.add(body);
+	}
+
+	// the body doing the checking in a solid contact is always awake and
+	// never static, so it's always in an island
+	for (int i = 0; i < m_contacts.getCount(); ++i)
+	{
+		PhysicsContact& contact = m_contacts[i];
+		if (!isSolid(contact))
+			continue;
+
+		int root = findIsland(contact.a->getIndex());
+		m_islands[m_islandIndex[root]]->contacts.add(i);
+	}
+}
+
+void PhysicsManager::solve()
+{
+	for (int i = 0; i < m_bodies.getCount(); ++i)
+		m_bodies[i]->getCollidingBodies().clear();
+
+	updateManifolds();
+	buildIslands();
+
+	auto solveRange = [this](int start, int end)
+	{
+		for (int i = start; i < end; ++i)
+			solveIsland(m_islands[i]);
+	};
+
+	// debug drawing isn't safe to do from multiple threads
+	if (m_debugDraw)
+		solveRange(0, m_islandCount);
+	else
+		forRange(m_islandCount, 1, solveRange);
+
+	for (int i = 0; i < m_contacts.getCount(); ++i)
+		m_contacts[i].a->reportContact(m_contacts[i]);
+}
+
+void PhysicsManager::updateManifolds()
+{
+	for (int i = 0; i < m_contacts.getCount(); ++i)
+	{
+		PhysicsContact& contact = m_contacts[i];
+		if (isSolid(contact))
+			m_manifolds[contact.key].update(contact, m_step);
+	}
+
+	// pairs that weren't found this step aren't touching anymore
+	m_cacheKeys.clear();
+	m_manifolds.getKeys(m_cacheKeys);
+	for (int i = 0; i < m_cacheKeys.getCount(); ++i)
+	{
+		unsigned long long key = m_cacheKeys[i];
+		if (m_manifolds.find(key)->lastStep != m_step)
+			m_manifolds.remove(key);
+	}
+
+	// nothing's added after this, so these pointers stay good while solving
+	for (int i = 0; i < m_contacts.getCount(); ++i)
+	{
+		PhysicsContact& contact = m_contacts[i];
+		if (isSolid(contact))
+			contact.manifold = m_manifolds.find(contact.key);
+	}
+}
+
+void PhysicsManager::solveIsland(PhysicsIsland* island)
+{
+	DArray<int>& contacts = island->contacts;
+
+	// start from last step's impulses, then fix them up a few times over
+	for (int i = 0; i < contacts.getCount(); ++i)
+		m_contacts[contacts[i]].manifold->warmStart();
+	for (int j = 0; j < velocityIterations; ++j)
+		for (int i = 0; i < contacts.getCount(); ++i)
+			m_contacts[contacts[i]].manifold->solveVelocity();
+
+	// then push them out of each other
+	for (int i = 0; i < contacts.getCount(); ++i)
+	{
+		PhysicsContact& contact = m_contacts[contacts[i]];
+		contact.a->solveContact(contact);
+	}
+}
+
+void PhysicsManager::updateSleep(float delta)
+{
+	for (int i = 0; i < m_bodies.getCount(); ++i)
+		m_bodies[i]->updateSleep(delta);
+
+	// an island only sleeps once every body in it has been still for long
+	// enough, otherwise bodies would fall asleep under things still moving
+	for (int i = 0; i < m_islandCount; ++i)
+	{
+		PhysicsIsland* island = m_islands[i];
+
+		bool still = true;
+		for (int j = 0; j < island->bodies.getCount() && still; ++j)
+			still = island->bodies[j]->isStill();
+
+		if (still)
+			sleepIsland(island);
+	}
+}
+
+void PhysicsManager::sleepIsland(PhysicsIsland* island)
+{
+	int index;
+	if (m_freeSleepingIslands.getCount() > 0)
+	{
+		index = m_freeSleepingIslands[m_freeSleepingIslands.getCount() - 1];
+		m_freeSleepingIslands.pop();
+	}
+	else
+	{
+		index = m_sleepingIslands.getCount();
+		m_sleepingIslands.add(nullptr);
+	}
+
+	auto sleeping = new DArray<PhysicsBody*>();
+	for (int i = 0; i < island->bodies.getCount(); ++i)
+	{
+		sleeping->add(island->bodies[i]);
+		island->bodies[i]->sleep(index);
+	}
+	m_sleepingIslands[index] = sleeping;
+}
+
+void PhysicsManager::wakeIsland(int index)
+{
+	DArray<PhysicsBody*>* sleeping = m_sleepingIslands[index];
+	m_sleepingIslands[index] = nullptr;
+	m_freeSleepingIslands.add(index);
+
+	// take each body out of the island first so waking it just wakes it
+	for (int i = 0; i < sleeping->getCount(); ++i)
+	{
+		PhysicsBody* body = (*sleeping)[i];
+		body->setSleepIsland(-1);
+		body->wakeUp();
+	}
+	delete sleeping;
+}
+
+void PhysicsManager::sync()
+{
+	// bodies already keep their own transforms, so all that's left is
+	// showing where they ended up
+	if (!m_debugDraw)
+		return;
+
+	for (int i = 0; i < m_bodies.getCount(); ++i)
+		m_bodies[i]->drawDebug();
+}
+
+void PhysicsManager::updateBroadphase(float delta)
+{
+	m_pairs.clear();
+
+	// resting bodies can't collide with each other, so they're only paired
+	// with the moving bodies that touch them
+	updateResting();
+
+	if (m_broadphase == BROADPHASE_OCTREE)
+	{
+		// SUPER BASIC APPROACH, just clearing and re-inserting all moving
+		// bodies into the tree each frame
+		m_tree->clear();
+		for (int i = 0; i < m_activeBodies.getCount(); ++i)
+		{
+			auto body = m_bodies[m_activeBodies[i]];
+			m_tree->insert(body, body->getBroadCube());
+		}
+
+		// then ask the tree what's near each body
+		for (int i = 0; i < m_activeBodies.getCount(); ++i)
+		{
+			auto body = m_bodies[m_activeBodies[i]];
+
+			// both bodies will find each other, so only keep the pair from
+			// the one with the lower id
+			m_inRange.clear();
+			m_tree->query(body->getBroadCube(), m_inRange);
+			for (int j = 0; j < m_inRange.getCount(); ++j)
+				if (m_inRange[j]->getId() > body->getId())
+					m_pairs.add({ body, m_inRange[j] });
+
+			findRestingPairs(body);
+		}
+		return;
+	}
+
+	if (m_broadphase == BROADPHASE_BVH)
+	{
+		for (int i = 0; i < m_activeBodies.getCount(); ++i)
+		{
+			auto body = m_bodies[m_activeBodies[i]];
+			int& handle = m_broadHandles[m_activeBodies[i]];
+
+			// stretch the box out by how far it'll move this step, so moving
+			// bodies don't have to be re-inserted every time
+			Vector3 displacement = body->getVelocity() * delta;
+			if (handle < 0)
+				handle = m_bvh.add(body, body->getBroadCube(), displacement);
+			else
+				m_bvh.move(handle, body->getBroadCube(), displacement);
+		}
+
+		// fat boxes are only good enough for the tree, so check the real
+		// boxes before something counts as a pair
+		for (int i = 0; i < m_activeBodies.getCount(); ++i)
+		{
+			auto body = m_bodies[m_activeBodies[i]];
+
+			m_inRange.clear();
+			OctCube cube = body->getBroadCube();
+			m_bvh.query(cube, m_inRange);
+
+			for (int j = 0; j < m_inRange.getCount(); ++j)
+			{
+				PhysicsBody* other = m_inRange[j];
+				if (other->getId() > body->getId() &&
+					cubesIntersect(cube, other->getBroadCube()))
+					m_pairs.add({ body, other });
+			}
+
+			findRestingPairs(body);
+		}
+		return;
+	}
+
+	// keep the sweep and prune in sync with the bodies, it only has to
+	// re-sort the ones that moved out of their fat boxes
+	for (int i = 0; i < m_activeBodies.getCount(); ++i)
+	{
+		auto body = m_bodies[m_activeBodies[i]];
+		int& handle = m_broadHandles[m_activeBodies[i]];
+
+		if (handle < 0)
+			handle = m_sap.add(body, body->getBroadCube());
+		else
+			m_sap.update(handle, body->getBroadCube());
+	}
+
+	// the sweep and prune orders pairs by handle, not id
+	m_sap.getPairs(m_pairs);
+	for (int i = 0; i < m_pairs.getCount(); ++i)
+	{
+		SAPPair<PhysicsBody*>& pair = m_pairs[i];
+		if (pair.a->getId() > pair.b->getId())
 		{
-			Vector3 pos = body->getPosition();
-			Vector3 extents = body->getBroadExtents();
-			// turn the body's extents into a volume usable by the octree
-			OctCube cube;
-			cube.minX = pos.x - extents.x;
-			cube.minY = pos.y - extents.y;
-			cube.minZ = pos.z - extents.z;
-
-			cube.maxX = pos.x + extents.x;
-			cube.maxY = pos.y + extents.y;
-			cube.maxZ = pos.z + extents.z;
-			m_tree->insert(body, cube);
+			PhysicsBody* temp = pair.a;
+			pair.a = pair.b;
+			pair.b = temp;
 		}
 	}
 
+	for (int i = 0; i < m_activeBodies.getCount(); ++i)
+		findRestingPairs(m_bodies[m_activeBodies[i]]);
+}
+
+void PhysicsManager::updateResting()
+{
+	m_activeBodies.clear();
+	m_stoppedHandles.clear();
 	for (int i = 0; i < m_bodies.getCount(); ++i)
-		m_bodies[i]->update(delta);
+	{
+		auto body = m_bodies[i];
+		// disabled bodies don't collide with anything, so they're in neither
+		bool enabled = body->isEnabled();
+		bool resting = enabled && body->isResting();
+
+		int& restingHandle = m_restingHandles[i];
+		if (resting)
+		{
+			// nothing moves a resting body apart from the game, so it only
+			// has to be put back in if that happened
+			if (restingHandle < 0)
+			{
+				restingHandle = m_restingTree.add(body, body->getBroadCube());
+			}
+			else if (body->hasMovedBroad())
+			{
+				// the boxes aren't fattened, so moving only re-inserts if it
+				// got bigger, which would leave it too big if it shrank
+				m_restingTree.remove(restingHandle);
+				restingHandle = m_restingTree.add(body, body->getBroadCube());
+			}
+		}
+		else if (restingHandle >= 0)
+		{
+			m_restingTree.remove(restingHandle);
+			restingHandle = -1;
+		}
+		body->clearMovedBroad();
+
+		if (enabled && !resting)
+		{
+			m_activeBodies.add(i);
+			continue;
+		}
+
+		// and it isn't moving, so it comes out of the other broadphase
+		int& handle = m_broadHandles[i];
+		if (handle >= 0)
+		{
+			m_stoppedHandles.add(handle);
+			handle = -1;
+		}
+	}
+
+	// a whole island goes to sleep at once, so take them all out together
+	// the sweep and prune squashes them all out of its lists in one pass
+	// when it's next asked for pairs (and merges bodies that woke up back
+	// in the same way), instead of one pass per body
+	for (int i = 0; i < m_stoppedHandles.getCount(); ++i)
+	{
+		if (m_broadphase == BROADPHASE_BVH)
+			m_bvh.remove(m_stoppedHandles[i]);
+		else if (m_broadphase == BROADPHASE_SAP)
+			m_sap.remove(m_stoppedHandles[i]);
+	}
+}
+
+void PhysicsManager::findRestingPairs(PhysicsBody* body)
+{
+	m_inRange.clear();
+	m_restingTree.query(body->getBroadCube(), m_inRange);
+
+	// pairs are always lower id first
+	for (int i = 0; i < m_inRange.getCount(); ++i)
+	{
+		PhysicsBody* other = m_inRange[i];
+		if (other->getId() < body->getId())
+			m_pairs.add({ other, body });
+		else
+			m_pairs.add({ body, other });
+	}
+}
+
+void PhysicsManager::setBroadphase(BroadphaseMode mode)
+{
+	if (mode == m_broadphase)
+		return;
+
+	// throw away whatever the old broadphase was keeping around, it'll be
+	// filled back up next update
+	// resting bodies are kept the same way whichever one's used
+	m_tree->clear();
+	m_sap.clear();
+	m_bvh.clear();
+	for (int i = 0; i < m_broadHandles.getCount(); ++i)
+		m_broadHandles[i] = -1;
+
+	m_broadphase = mode;
 }
 
 void PhysicsManager::clear()
 {
+	// the bodies still exist, they just aren't stepped anymore
+	for (int i = 0; i < m_bodies.getCount(); ++i)
+	{
+		m_bodies[i]->setInWorld(false);
+		m_bodies[i]->setSleepIsland(-1);
+	}
 	m_bodies.clear();
+	m_pairs.clear();
+	m_contacts.clear();
+
+	m_manifolds.clear();
+	m_axisCache.clear();
+
+	m_islandCount = 0;
+	for (int i = 0; i < m_sleepingIslands.getCount(); ++i)
+		delete m_sleepingIslands[i];
+	m_sleepingIslands.clear();
+	m_freeSleepingIslands.clear();
+
+	m_tree->clear();
+	m_sap.clear();
+	m_bvh.clear();
+	m_broadHandles.clear();
+	m_restingTree.clear();
+	m_restingHandles.clear();
 }
 
 DArray<PhysicsBody*> PhysicsManager::getBodiesInRange(Vector3 const& min, 
@@ -118,7 +846,17 @@ DArray<PhysicsBody*> PhysicsManager::getBodiesInRange(Vector3 const& min,
 	volume.maxY = max.y;
 	volume.maxZ = max.z;
 
-	return m_tree->getInRange(volume);
+	DArray<PhysicsBody*> result;
+	if (m_broadphase == BROADPHASE_OCTREE)
+		m_tree->query(volume, result);
+	else if (m_broadphase == BROADPHASE_BVH)
+		m_bvh.query(volume, result);
+	else
+		m_sap.query(volume, result);
+
+	// static and sleeping bodies aren't in any of those
+	m_restingTree.query(volume, result);
+	return result;
 }
 
 // performs a ray cast on all bodies WITH AN AABB COLLIDER, not implemented for
@@ -135,9 +873,20 @@ PhysicsBody* PhysicsManager::rayCast(Vector3 const& start,
 	float closestDist = INFINITY;
 	PhysicsBody* closest = nullptr;
 
-	for (int i = 0; i < m_bodies.getCount(); ++i)
+	// the bvh can cut down what needs testing to what the ray passes near,
+	// otherwise everything has to be tested
+	DArray<PhysicsBody*>* toTest = &m_bodies;
+	if (m_broadphase == BROADPHASE_BVH)
 	{
-		PhysicsBody* body = m_bodies[i];
+		m_inRange.clear();
+		m_bvh.rayCast(nStart, nDir, FLT_MAX, m_inRange);
+		m_restingTree.rayCast(nStart, nDir, FLT_MAX, m_inRange);
+		toTest = &m_inRange;
+	}
+
+	for (int i = 0; i < toTest->getCount(); ++i)
+	{
+		PhysicsBody* body = (*toTest)[i];
 		Collider* collider = body->getCollider();
 
 		if (!collider || !body->isEnabled())
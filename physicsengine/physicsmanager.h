@@ -10,10 +10,90 @@
 #pragma once
 
 #include <darray.h>
+#include <functional>
 #include <octree.h>
 #include <vector3.h>
+#include <sweepandprune.h>
+#include <aabbtree.h>
+#include <hashmap.h>
+
+#include "bodystore.h"
+#include "contactmanifold.h"
 
 class PhysicsBody;
+class PhysicsDebugDraw;
+class JobSystem;
+struct PhysicsContact;
+
+// which structure is used to find bodies that might be colliding
+// only bodies that are moving are kept in it, static and sleeping bodies are
+// kept in a tree of their own that's only changed when they are, so the
+// broadphase only costs as much as what's moving
+enum BroadphaseMode
+{
+	// rebuilds an octree from scratch every step
+	BROADPHASE_OCTREE,
+	// incremental sweep and prune, only re-sorts what moved far enough
+	BROADPHASE_SAP,
+	// dynamic bounding volume hierarchy, bodies only move around the tree
+	// once they leave their fattened boxes and there's no size limit
+	BROADPHASE_BVH
+};
+
+// stages of a physics step, in the order they're run
+enum PhysicsStage
+{
+	// gravity, drag and moving bodies by their velocities
+	STAGE_INTEGRATE,
+	// finding pairs of bodies that might be colliding, and moving fast
+	// continuous bodies back to whatever they hit
+	STAGE_BROADPHASE,
+	// finding contacts between those pairs
+	STAGE_NARROWPHASE,
+	// pushing bodies apart and applying forces for each contact, one island
+	// at a time
+	STAGE_SOLVE,
+	// putting islands that haven't moved to sleep
+	STAGE_SLEEP,
+	// finishing bodies off so they can be read back
+	STAGE_SYNC,
+
+	STAGE_COUNT
+};
+
+// a group of bodies that are touching each other (directly or through other
+// bodies), static bodies aren't part of any island since they'd join
+// everything sitting on them together
+// islands don't share anything that gets written to, so they can be solved
+// at the same time, and they're put to sleep and woken up as one
+struct PhysicsIsland
+{
+	DArray<PhysicsBody*> bodies;
+	// indices of the island's contacts in the contact list, in order
+	DArray<int> contacts;
+};
+
+// SAT axis that decided a pair last time it was checked, it'll usually
+// decide it again
+struct CachedAxis
+{
+	// id of the body that did the checking, axes are numbered from its side
+	int checker;
+	int axis;
+	// last step the pair came out of the broadphase
+	int lastStep;
+};
+
+// what the narrowphase did with a pair, kept until every thread is done so
+// the axis cache can be updated on one thread
+struct PairResult
+{
+	// id of the body that did the checking, -1 if neither body did
+	int checker;
+	// axis that was tried first and the axis that decided it, -1 for none
+	int hint;
+	int axis;
+};
 
 class PhysicsManager
 {
@@ -23,9 +103,16 @@ public:
 
 	static PhysicsManager* getInstance();
 
+	// runs one whole step of the physics world, every stage in order
+	// bodies shouldn't be stepped anywhere else
 	void update(float delta);
 	void clear();
 
+	// how long a stage took last step, in milliseconds
+	float getStageTime(PhysicsStage stage) { return m_stageTimes[stage]; }
+	// gets the name of a stage, for printing timings
+	static const char* getStageName(PhysicsStage stage);
+
 	// adds a physics body to the world
 	void addPhysicsBody(PhysicsBody* b);
 
@@ -35,19 +122,50 @@ public:
 	PhysicsBody* rayCast(Vector3 const& start, Vector3 const& dir, 
 		Vector3& outPos);
 
-	// grabs a pointer to the octree containing all our bodies
+	// grabs a pointer to the octree containing all our moving bodies
+	// only filled in when using BROADPHASE_OCTREE
 	Octree<PhysicsBody*>* getTree() { return m_tree; }
+
+	// changes which broadphase is used, can be done at any time
+	void setBroadphase(BroadphaseMode mode);
+	BroadphaseMode getBroadphase() { return m_broadphase; }
 	
 	// gets a pointer to our list of bodies
 	DArray<PhysicsBody*>* getBodies() { return &m_bodies; }
-	// uses the octree to get a list of bodies in a certain range
+	// where every body keeps its data, even ones that haven't been added
+	BodyStore* getBodyStore() { return &m_bodyStore; }
+
+	// how many pairs checked with SAT last step were decided by the axis
+	// that decided them the step before, and how many weren't
+	int getAxisCacheHits() { return m_axisHits; }
+	int getAxisCacheMisses() { return m_axisMisses; }
+	// uses the broadphase to get a list of bodies in a certain range
 	DArray<PhysicsBody*> getBodiesInRange(Vector3 const& min, 
 		Vector3 const& max);
 
     static float gravity;
+	// how many times the velocities of each island are solved per step,
+	// more is stiffer but slower
+	static int velocityIterations;
 
 	// draws an octree for debug purposes
 	void drawTree(Octree<PhysicsBody*>* tree);
+
+	// sets what debug information gets drawn with, the physics doesn't own it
+	// nullptr turns debug drawing off completely
+	void setDebugDraw(PhysicsDebugDraw* d) { m_debugDraw = d; }
+	PhysicsDebugDraw* getDebugDraw() { return m_debugDraw; }
+
+	// sets what stages are spread across threads with, the physics doesn't
+	// own it either
+	// nullptr runs everything on the calling thread, the results are the same
+	// either way
+	void setJobSystem(JobSystem* j) { m_jobs = j; }
+	JobSystem* getJobSystem() { return m_jobs; }
+
+	// wakes up every body in a sleeping island, PhysicsBody::wakeUp does this
+	// for whichever island the body is in
+	void wakeIsland(int index);
 private:
 	PhysicsManager();
 	~PhysicsManager();
@@ -55,6 +173,118 @@ private:
 	static PhysicsManager* m_instance;
 
 	DArray<PhysicsBody*> m_bodies;
+	BodyStore m_bodyStore;
+
+	BroadphaseMode m_broadphase;
 	Octree<PhysicsBody*>* m_tree;
 
+	SweepAndPrune<PhysicsBody*> m_sap;
+	AABBTree<PhysicsBody*> m_bvh;
+	// each body's handle in the sweep and prune or bvh, lines up with
+	// m_bodies, -1 when the body isn't in it
+	DArray<int> m_broadHandles;
+	// static and sleeping bodies, whichever broadphase is being used
+	// boxes aren't fattened since these bodies don't move by themselves
+	AABBTree<PhysicsBody*> m_restingTree;
+	// each body's handle in the resting tree, lines up with m_bodies, -1
+	// when the body isn't resting
+	DArray<int> m_restingHandles;
+	// indices into m_bodies of the bodies that need checking this step
+	DArray<int> m_activeBodies;
+	// broadphase handles of bodies that stopped moving this step, taken out
+	// all together once every body's been looked at
+	DArray<int> m_stoppedHandles;
+	// overlapping pairs the broadphase found this step, each pair is only in
+	// here once with the lower id first
+	DArray<SAPPair<PhysicsBody*>> m_pairs;
+	// id given to the next body that's added
+	int m_nextId;
+	// reused for bvh queries so they don't allocate every time
+	DArray<PhysicsBody*> m_inRange;
+	// pairs with a swept body in them, swept body first, and the bodies
+	// one swept body is being checked against
+	DArray<SAPPair<PhysicsBody*>> m_sweepPairs;
+	DArray<PhysicsBody*> m_sweepOthers;
+
+	// contacts the narrowphase found this step, waiting to be solved
+	DArray<PhysicsContact> m_contacts;
+	// contacts each thread found, so threads never write to the same place
+	DArray<DArray<PhysicsContact>*> m_threadContacts;
+
+	// axis that decided each pair last time, by contact key
+	// only read during the narrowphase, and updated after it
+	HashMap<CachedAxis> m_axisCache;
+	// lines up with m_pairs, each pair's result is only written by the
+	// thread that checked it
+	DArray<PairResult> m_pairResults;
+	int m_axisHits;
+	int m_axisMisses;
+
+	// manifolds for every pair of bodies that are touching, by contact key
+	HashMap<ContactManifold> m_manifolds;
+	// reused for finding manifolds and cached axes that are out of date
+	DArray<unsigned long long> m_cacheKeys;
+	// number of steps run so far, used to tell which cached things are stale
+	int m_step;
+
+	// union-find over BodyStore slots, each slot points towards the slot
+	// at the root of its island
+	DArray<int> m_islandParent;
+	// island each root slot's bodies are in, -1 if it doesn't have one yet
+	DArray<int> m_islandIndex;
+	// islands found this step, kept around between steps so they don't
+	// have to be reallocated (only the first m_islandCount are used)
+	DArray<PhysicsIsland*> m_islands;
+	int m_islandCount;
+	// bodies in each island that's asleep, null for slots that are free
+	DArray<DArray<PhysicsBody*>*> m_sleepingIslands;
+	DArray<int> m_freeSleepingIslands;
+
+	// finds the root slot of a slot's island
+	int findIsland(int slot);
+	// joins two slots' islands together
+	void joinIslands(int a, int b);
+	// refreshes the manifold of every contact and throws out the manifolds
+	// of pairs that stopped touching
+	void updateManifolds();
+	// groups awake bodies and the contacts between them into islands
+	void buildIslands();
+	// solves every contact in an island, in order
+	void solveIsland(PhysicsIsland* island);
+	// puts every body in an island to sleep as one sleeping island
+	void sleepIsland(PhysicsIsland* island);
+
+	JobSystem* m_jobs;
+	// runs a function over a range of indices, across threads if there's a
+	// job system
+	void forRange(int count, int batchSize,
+		std::function<void(int, int)> func);
+
+	float m_stageTimes[STAGE_COUNT];
+
+	// the stages of a step, see PhysicsStage
+	void integrate(float delta);
+	// fills the pair list using the current broadphase
+	void updateBroadphase(float delta);
+	// moves bodies in and out of the resting tree, and makes the list of
+	// bodies that aren't resting
+	void updateResting();
+	// adds a pair for every resting body a moving body's box touches
+	void findRestingPairs(PhysicsBody* body);
+	// moves swept bodies that went through something this step back to
+	// where they hit it, using the pairs the broadphase found
+	void sweepFastBodies(float delta);
+	// finds contacts for every pair, once each
+	void narrowphase();
+	// finds contacts for a range of pairs, putting them in the calling
+	// thread's buffer
+	void findContacts(int start, int end);
+	// remembers which axis decided each pair for next step
+	void updateAxisCache();
+	void solve();
+	void updateSleep(float delta);
+	void sync();
+
+	PhysicsDebugDraw* m_debugDraw;
+
 };
@@ -0,0 +1,176 @@
+/* =================================
+ *  PhysicsThread
+ *  Steps the PhysicsManager on its own thread and hands snapshots of the
+ *  bodies over to whoever's drawing them
+ * ================================= */
+#include "physicsthread.h"
+
+#include <jobsystem.h>
+#include <vector3.h>
+
+#include "bodystore.h"
+#include "physicsbody.h"
+#include "physicsmanager.h"
+
+// set on m_ready when the snapshot in it hasn't been picked up yet
+#define SNAPSHOT_FRESH 4
+// the snapshot index part of m_ready
+#define SNAPSHOT_INDEX 3
+
+float PhysicsSnapshot::getAlpha()
+{
+	if (step < 0 || stepLength <= 0.0f)
+		return 1.0f;
+
+	std::chrono::duration<float> since = Clock::now() - time;
+	float alpha = since.count() / stepLength;
+	// the next snapshot is late, so just sit at the end of this one
+	return alpha < 1.0f ? alpha : 1.0f;
+}
+
+bool PhysicsSnapshot::getTransform(PhysicsBody* body, float alpha,
+	Transform& out)
+{
+	int index = body->getIndex();
+	if (index < 0 || index >= ids.getCount() || ids[index] != body->getId())
+		return false;
+
+	out = Transform(
+		Vector3::lerpBetween(previous[index].position,
+			current[index].position, alpha),
+		Quaternion::lerpBetween(previous[index].rotation,
+			current[index].rotation, alpha));
+	return true;
+}
+
+bool PhysicsSnapshot::getBroadExtents(PhysicsBody* body, Vector3& out)
+{
+	int index = body->getIndex();
+	if (index < 0 || index >= ids.getCount() || ids[index] != body->getId())
+		return false;
+
+	out = extents[index];
+	return true;
+}
+
+PhysicsThread::PhysicsThread(float step, int maxSteps, int workers)
+	: m_running(false), m_stepper(step, maxSteps), m_steps(0),
+	m_workers(workers), m_back(0), m_front(1), m_ready(2) { }
+
+PhysicsThread::~PhysicsThread()
+{
+	stop();
+}
+
+void PhysicsThread::start()
+{
+	if (m_running)
+		return;
+
+	m_running = true;
+	m_stepper.reset();
+	m_thread = std::thread(&PhysicsThread::run, this);
+}
+
+void PhysicsThread::stop()
+{
+	m_running = false;
+	if (m_thread.joinable())
+		m_thread.join();
+}
+
+PhysicsSnapshot* PhysicsThread::getSnapshot()
+{
+	// swap the one being read for the ready one, but only if it's newer,
+	// otherwise the old one would come back around
+	if (m_ready.load() & SNAPSHOT_FRESH)
+		m_front = m_ready.exchange(m_front) & SNAPSHOT_INDEX;
+	return &m_snapshots[m_front];
+}
+
+void PhysicsThread::run()
+{
+	typedef PhysicsSnapshot::Clock Clock;
+
+	PhysicsManager* physics = PhysicsManager::getInstance();
+
+	// the JobSystem has to be made on this thread for it to be able to wait
+	// on its own jobs
+	JobSystem* jobs = nullptr;
+	JobSystem* oldJobs = nullptr;
+	if (m_workers != 0)
+	{
+		jobs = new JobSystem(m_workers);
+		m_worldLock.lock();
+		oldJobs = physics->getJobSystem();
+		physics->setJobSystem(jobs);
+		m_worldLock.unlock();
+	}
+
+	Clock::time_point last = Clock::now();
+	while (m_running)
+	{
+		Clock::time_point now = Clock::now();
+		std::chrono::duration<float> frame = now - last;
+		last = now;
+
+		int steps = m_stepper.advance(frame.count());
+		for (int i = 0; i < steps && m_running; ++i)
+		{
+			m_worldLock.lock();
+			physics->update(m_stepper.getStep());
+			publish();
+			m_worldLock.unlock();
+		}
+
+		// sleep until the next step is due
+		float wait = (1.0f - m_stepper.getAlpha()) * m_stepper.getStep();
+		std::this_thread::sleep_until(now +
+			std::chrono::duration_cast<Clock::duration>(
+				std::chrono::duration<float>(wait)));
+	}
+
+	if (jobs)
+	{
+		m_worldLock.lock();
+		physics->setJobSystem(oldJobs);
+		m_worldLock.unlock();
+		delete jobs;
+	}
+}
+
+void PhysicsThread::publish()
+{
+	BodyStore* store = PhysicsManager::getInstance()->getBodyStore();
+	PhysicsSnapshot& snapshot = m_snapshots[m_back];
+
+	// clearing keeps the memory, so once there's been a step with this many
+	// bodies adding them back doesn't allocate
+	snapshot.previous.clear();
+	snapshot.current.clear();
+	snapshot.ids.clear();
+	snapshot.extents.clear();
+	for (int i = 0; i < store->getCount(); ++i)
+	{
+		snapshot.previous.add(Transform(
+			Vector3(store->prevX[i], store->prevY[i], store->prevZ[i]),
+			store->prevOrientations[i]));
+		snapshot.current.add(Transform(
+			Vector3(store->posX[i], store->posY[i], store->posZ[i]),
+			store->orientations[i]));
+
+		// disabled bodies are left wherever they were last drawn
+		int drawn = BODY_USED | BODY_IN_WORLD | BODY_ENABLED;
+		bool inWorld = (store->flags[i] & drawn) == drawn;
+		snapshot.ids.add(inWorld ? store->bodies[i]->getId() : -1);
+		snapshot.extents.add(inWorld ?
+			store->bodies[i]->getBroadExtents() : Vector3());
+	}
+
+	snapshot.step = m_steps++;
+	snapshot.stepLength = m_stepper.getStep();
+	snapshot.time = PhysicsSnapshot::Clock::now();
+
+	// put it up as the ready one and take whatever was there to write next
+	m_back = m_ready.exchange(m_back | SNAPSHOT_FRESH) & SNAPSHOT_INDEX;
+}
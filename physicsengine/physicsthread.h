@@ -0,0 +1,162 @@
+/* =================================
+ *  PhysicsThread
+ *  Steps the PhysicsManager on its own thread at a fixed rate, so a slow
+ *  physics step doesn't hold up drawing and waiting on vsync doesn't hold
+ *  up the physics
+ *
+ *  After every step the thread copies where every body is into a snapshot
+ *  and hands it over without locking anything, through three buffers: one
+ *  being written, one being read, and the newest finished one waiting to
+ *  be picked up. Drawing only ever looks at snapshots
+ *
+ *  Anything else that touches bodies or the PhysicsManager (adding bodies,
+ *  setting velocities, ray casts) has to hold the world lock while it does,
+ *  which the thread only takes while it's stepping
+ *
+ *  A JobSystem waited on from a thread other than the one that made it has
+ *  to share the owner's queue, so rather than use the PhysicsManager's one
+ *  from here the thread makes its own when it's given some workers, and
+ *  puts the old one back when it stops
+ *
+ *		PhysicsThread* thread = new PhysicsThread(1.0f / 60.0f, 5);
+ *		thread->start();
+ *		...
+ *		thread->lock();
+ *		body->setVelocity(v);
+ *		thread->unlock();
+ *		...
+ *		PhysicsSnapshot* snapshot = thread->getSnapshot();
+ *		Transform t;
+ *		if (snapshot->getTransform(body, snapshot->getAlpha(), t))
+ *			draw(t);
+ * ================================= */
+#pragma once
+
+#include <atomic>
+#include <chrono>
+#include <mutex>
+#include <thread>
+
+#include <darray.h>
+#include <fixedstepper.h>
+#include <transform.h>
+
+class PhysicsBody;
+
+struct PhysicsSnapshot
+{
+	typedef std::chrono::steady_clock Clock;
+
+	// where each body was before and after the step, by BodyStore slot
+	DArray<Transform> previous;
+	DArray<Transform> current;
+	// id of the body in each slot, -1 for empty slots, so a body that's been
+	// given a reused slot since the snapshot was taken isn't mixed up with
+	// whatever was there before
+	DArray<int> ids;
+	// half-size of each body's broad box after the step, for drawing
+	DArray<Vector3> extents;
+
+	// number of the step this was taken after, and when
+	int step;
+	Clock::time_point time;
+	// length of the step
+	float stepLength;
+
+	PhysicsSnapshot() : step(-1), stepLength(0.0f) {}
+
+	/***
+	 * @brief Gets how far through the step after this one it is right now,
+	 *			for drawing bodies part way between where they were before
+	 *			and after this step (which is a step behind, but smooth)
+	 *
+	 * @return 0 for right as the snapshot was taken, up to 1 a step later
+	 */
+	float getAlpha();
+
+	/***
+	 * @brief Gets where a body should be drawn
+	 *
+	 * @param body Body to look for
+	 * @param alpha How far between before and after the step to put it
+	 * @param out Filled in with the transform if the body's in here
+	 * @return False if the body wasn't in the world and enabled when this
+	 *			was taken
+	 */
+	bool getTransform(PhysicsBody* body, float alpha, Transform& out);
+
+	/***
+	 * @brief Gets the size of a body's broad box as of this snapshot
+	 *
+	 * @param body Body to look for
+	 * @param out Filled in with the half-size if the body's in here
+	 * @return False if the body wasn't in the world and enabled when this
+	 *			was taken
+	 */
+	bool getBroadExtents(PhysicsBody* body, Vector3& out);
+};
+
+class PhysicsThread
+{
+public:
+	/***
+	 * @brief Makes a thread for stepping the PhysicsManager, which has to
+	 *			exist already, it doesn't start until start() is called
+	 *			The PhysicsManager's debug drawing isn't thread safe, so it
+	 *			should be turned off while this is running
+	 *
+	 * @param step Length of each step
+	 * @param maxSteps Most steps that are run to catch up at once, time
+	 *			past that is thrown away
+	 * @param workers Number of worker threads for the physics thread's own
+	 *			JobSystem, 0 to not use one and -1 for one per spare core
+	 */
+	PhysicsThread(float step, int maxSteps, int workers = 0);
+	// stops the thread if it's still going
+	~PhysicsThread();
+
+	void start();
+	// waits for the step that's running to finish, then stops
+	void stop();
+	bool isRunning() { return m_running; }
+
+	// stops the thread from stepping while bodies are being changed from
+	// another thread, it finishes whatever step it's in first
+	void lock() { m_worldLock.lock(); }
+	void unlock() { m_worldLock.unlock(); }
+
+	/***
+	 * @brief Gets the newest snapshot that's been finished
+	 *			Only one thread should ever call this, and the snapshot it
+	 *			gives back is good until the next time it's called
+	 *
+	 * @return The snapshot, which has a step of -1 if there hasn't been a
+	 *			step yet
+	 */
+	PhysicsSnapshot* getSnapshot();
+
+	float getStep() { return m_stepper.getStep(); }
+
+private:
+	// the thread's loop, steps whenever a step's worth of time has passed
+	void run();
+	// copies every body into the back snapshot and swaps it to be ready
+	void publish();
+
+	std::thread m_thread;
+	std::atomic<bool> m_running;
+	std::mutex m_worldLock;
+
+	FixedStepper m_stepper;
+	int m_steps;
+	int m_workers;
+
+	// the three snapshots, m_back is only touched by the physics thread and
+	// m_front only by whoever is reading
+	// m_ready is the finished one waiting to be picked up, with
+	// SNAPSHOT_FRESH set if it's newer than m_front
+	PhysicsSnapshot m_snapshots[3];
+	int m_back;
+	int m_front;
+	std::atomic<int> m_ready;
+};
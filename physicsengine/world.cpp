@@ -13,6 +13,7 @@
 #include "objectpool.h"
 #include "physicsbody.h"
 #include "physicsactor.h"
+#include "physicsthread.h"
 #include "shapes.h"
 
 World::World(Game* game)
@@ -42,16 +43,41 @@ void World::addActor(Actor* a)
 
 void World::update(float delta)
 {
+	// physics has already been stepped, so get actors up to date before
+	// they do anything with their positions
+	syncPhysics();
+
 	for (int i = 0; i < m_actors.getCount(); ++i)
 		if (m_actors[i]->isEnabled())
 			m_actors[i]->update(delta);
-    aie::Gizmos::clear();
+}
+
+void World::syncPhysics(float alpha)
+{
+	for (int i = 0; i < m_physicsActors.getCount(); ++i)
+		m_physicsActors[i]->syncFromBody(alpha);
+}
+
+void World::syncSnapshot(PhysicsSnapshot* snapshot)
+{
+	float alpha = snapshot->getAlpha();
+	for (int i = 0; i < m_physicsActors.getCount(); ++i)
+		m_physicsActors[i]->syncFromSnapshot(snapshot, alpha);
 }
 
 void World::draw()
 {
 	using namespace aie;
 
+	// frames don't line up with physics steps, so draw everything part way
+	// between the last two steps (the next update puts them back)
+	// physics on another thread can't be looked at while it's stepping, so
+	// the last snapshot it published is drawn instead
+	PhysicsThread* physicsThread = m_game->getPhysicsThread();
+	if (physicsThread)
+		syncSnapshot(physicsThread->getSnapshot());
+	else
+		syncPhysics(m_game->getInterpolation());
 
 	for (int i = 0; i < m_actors.getCount(); ++i)
 		if (m_actors[i]->isEnabled())
@@ -9,6 +9,7 @@ class Camera;
 class ObjectPool;
 class PhysicsBody;
 class PhysicsActor;
+struct PhysicsSnapshot;
 class Game;
 
 class World
@@ -22,6 +23,13 @@ public:
 	void update(float delta);
 	void draw();
 
+	// copies every physics body's transform onto its actor, in one go
+	// alpha is how far between the last two physics steps to put them
+	void syncPhysics(float alpha = 1.0f);
+	// same but from a snapshot of the bodies, for when physics is on its own
+	// thread
+	void syncSnapshot(PhysicsSnapshot* snapshot);
+
 	ObjectPool* getPool();
 
 	PhysicsActor* getActorWithBody(PhysicsBody* body);